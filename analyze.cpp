@@ -0,0 +1,326 @@
+#include "analyze.h"
+#include "hash.h"
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+// HyperLogLog with 2^14 one-byte registers, ~0.8% standard error
+class HyperLogLog
+{
+public:
+    HyperLogLog() : reg(M, 0) {}
+
+    void add(long long key)
+    {
+        uint64_t h = mix64((uint64_t)key);
+        size_t idx = h >> (64 - P);
+        uint64_t w = (h << P) | (1ULL << (P - 1));
+        uint8_t rank = (uint8_t)(__builtin_clzll(w) + 1);
+        if (rank > reg[idx]) reg[idx] = rank;
+    }
+
+    double estimate() const
+    {
+        double sum = 0;
+        int zeros = 0;
+        for (size_t i = 0; i < M; i++) {
+            sum += ldexp(1.0, -reg[i]);
+            if (reg[i] == 0) zeros++;
+        }
+        double alpha = 0.7213 / (1.0 + 1.079 / M);
+        double e = alpha * M * M / sum;
+        // linear counting while many registers are still empty
+        if (e <= 2.5 * M && zeros > 0) e = M * log((double)M / zeros);
+        return e;
+    }
+
+    size_t bytes() const { return reg.size(); }
+
+private:
+    static const int P = 14;
+    static const size_t M = 1 << P;
+    vector<uint8_t> reg;
+};
+
+// Count-min sketch with conservative update: only the counters equal to
+// the current minimum are incremented, which tightens the overestimate
+class CountMin
+{
+public:
+    CountMin() : table(DEPTH * WIDTH, 0) {}
+
+    uint32_t add(long long key)
+    {
+        uint64_t h = mix64((uint64_t)key);
+        size_t at[DEPTH];
+        uint32_t est = UINT32_MAX;
+        for (int i = 0; i < DEPTH; i++) {
+            at[i] = slot(i, h);
+            est = min(est, table[at[i]]);
+        }
+        if (est == UINT32_MAX) return est;
+        for (int i = 0; i < DEPTH; i++) {
+            if (table[at[i]] == est) table[at[i]]++;
+        }
+        return est + 1;
+    }
+
+    size_t bytes() const { return table.size() * sizeof(uint32_t); }
+
+private:
+    static const int DEPTH = 4;
+    static const size_t WIDTH = 1 << 16;
+    vector<uint32_t> table;
+
+    size_t slot(int i, uint64_t h) const
+    {
+        uint64_t h1 = h & 0xffffffffULL;
+        uint64_t h2 = (h >> 32) | 1;
+        return (size_t)i * WIDTH + ((h1 + i * h2) & (WIDTH - 1));
+    }
+};
+
+// The K keys with the largest estimates, as a min-heap indexed by key so
+// a tracked key's count can be raised in place
+class TopK
+{
+public:
+    explicit TopK(size_t k) : K(k) {}
+
+    void offer(long long key, uint32_t count)
+    {
+        auto it = where.find(key);
+        if (it != where.end()) {
+            heap[it->second].first = count;
+            siftDown(it->second);
+            return;
+        }
+        if (heap.size() < K) {
+            heap.push_back(make_pair(count, key));
+            where[key] = heap.size() - 1;
+            siftUp(heap.size() - 1);
+        } else if (count > heap[0].first) {
+            where.erase(heap[0].second);
+            heap[0] = make_pair(count, key);
+            where[key] = 0;
+            siftDown(0);
+        }
+    }
+
+    // largest first
+    vector<pair<uint32_t, long long> > sorted() const
+    {
+        vector<pair<uint32_t, long long> > v(heap);
+        sort(v.rbegin(), v.rend());
+        return v;
+    }
+
+private:
+    size_t K;
+    vector<pair<uint32_t, long long> > heap;
+    unordered_map<long long, size_t> where;
+
+    void swapAt(size_t a, size_t b)
+    {
+        swap(heap[a], heap[b]);
+        where[heap[a].second] = a;
+        where[heap[b].second] = b;
+    }
+
+    void siftUp(size_t i)
+    {
+        while (i > 0 && heap[i].first < heap[(i - 1) / 2].first) {
+            swapAt(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void siftDown(size_t i)
+    {
+        for (;;) {
+            size_t l = 2 * i + 1, r = l + 1, m = i;
+            if (l < heap.size() && heap[l].first < heap[m].first) m = l;
+            if (r < heap.size() && heap[r].first < heap[m].first) m = r;
+            if (m == i) return;
+            swapAt(i, m);
+            i = m;
+        }
+    }
+};
+
+struct TraceAnalyzer::Impl
+{
+    static const int SIZE_BUCKETS = 12;      // request pages: 1, 2, 3-4, ... 1024+
+    static const int REUSE_BUCKETS = 33;     // [0] first sighting, [b] 2^(b-1) <= t < 2^b
+    static const int TOP_K = 100;
+    static const int TOP_REPORTED = 10;
+    static const size_t SAMPLE_LIMIT = 1 << 14;
+    static const uint64_t SAMPLE_SPACE = 1 << 24;
+
+    long long requests = 0;
+    long long refs = 0;
+    long long readRefs = 0;
+    long long writeRefs = 0;
+    long long readRequests = 0;
+    long long writeRequests = 0;
+
+    // pages of the request being read; requests are closed lazily
+    long long reqPages = 0;
+    bool reqWrite = false;
+    long long sizeHist[SIZE_BUCKETS] = {};
+
+    HyperLogLog distinct;
+    HyperLogLog distinctWritten;
+    CountMin counts;
+    TopK top;
+
+    // Spatially sampled reuse times: a page is tracked if its hash falls
+    // below threshold; the threshold halves whenever the table is full
+    uint64_t threshold = SAMPLE_SPACE;
+    unordered_map<long long, long long> lastSeen;
+    double reuseHist[REUSE_BUCKETS] = {};
+
+    Impl() : top(TOP_K) { lastSeen.reserve(SAMPLE_LIMIT + 1); }
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    static int log2Bucket(long long v) {
+        int b = 0;
+        while (v > 1) {
+            v >>= 1;
+            b++;
+        }
+        return b;
+    }
+
+    void closeRequest() {
+        if (reqPages == 0) return;
+        requests++;
+        if (reqWrite) writeRequests++; else readRequests++;
+        // ceil(log2) so that 3-4 pages share a bucket
+        int b = log2Bucket(reqPages - 1) + (reqPages > 1 ? 1 : 0);
+        sizeHist[min(b, SIZE_BUCKETS - 1)]++;
+        reqPages = 0;
+    }
+
+    void sampleReuse(long long k) {
+        uint64_t h = mix64((uint64_t)k ^ 0x9e3779b97f4a7c15ULL) >> 40;
+        if (h >= threshold) return;
+        double weight = (double)SAMPLE_SPACE / threshold;
+
+        auto it = lastSeen.find(k);
+        if (it == lastSeen.end()) {
+            reuseHist[0] += weight;
+            lastSeen[k] = refs;
+        } else {
+            reuseHist[min(1 + log2Bucket(refs - it->second), REUSE_BUCKETS - 1)] += weight;
+            it->second = refs;
+        }
+
+        if (lastSeen.size() > SAMPLE_LIMIT) {
+            threshold /= 2;
+            for (auto s = lastSeen.begin(); s != lastSeen.end();) {
+                if ((mix64((uint64_t)s->first ^ 0x9e3779b97f4a7c15ULL) >> 40) >= threshold) s = lastSeen.erase(s);
+                else ++s;
+            }
+        }
+    }
+
+    void access(long long k, const string& rw) {
+        bool write = isWrite(rw);
+        refs++;
+        if (write) writeRefs++; else readRefs++;
+        reqPages++;
+        reqWrite = write;
+
+        distinct.add(k);
+        if (write) distinctWritten.add(k);
+        top.offer(k, counts.add(k));
+        sampleReuse(k);
+    }
+
+    // least-squares slope of ln(count) over ln(rank) for the heavy hitters
+    double zipfAlpha(const vector<pair<uint32_t, long long> >& ranked) const {
+        double sx = 0, sy = 0, sxx = 0, sxy = 0;
+        int n = 0;
+        for (size_t i = 0; i < ranked.size(); i++) {
+            if (ranked[i].first == 0) break;
+            double x = log((double)(i + 1)), y = log((double)ranked[i].first);
+            sx += x; sy += y; sxx += x * x; sxy += x * y;
+            n++;
+        }
+        if (n < 2 || n * sxx - sx * sx == 0) return 0.0;
+        return -(n * sxy - sx * sy) / (n * sxx - sx * sx);
+    }
+};
+
+const int TraceAnalyzer::Impl::SIZE_BUCKETS;
+const int TraceAnalyzer::Impl::REUSE_BUCKETS;
+
+TraceAnalyzer::TraceAnalyzer()
+{
+    p = new Impl();
+}
+
+TraceAnalyzer::~TraceAnalyzer()
+{
+    delete p;
+}
+
+void TraceAnalyzer::refer(long long int addr, string rw)
+{
+    p->access(addr, rw);
+}
+
+void TraceAnalyzer::onRequest(long long int timestamp)
+{
+    p->closeRequest();
+}
+
+void TraceAnalyzer::report()
+{
+    p->closeRequest();
+
+    vector<pair<uint32_t, long long> > ranked = p->top.sorted();
+    double pages = p->distinct.estimate();
+    size_t sketchBytes = p->distinct.bytes() + p->distinctWritten.bytes() + p->counts.bytes()
+        + Impl::TOP_K * (sizeof(pair<uint32_t, long long>) + 32)
+        + Impl::SAMPLE_LIMIT * 32;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "Analyze requests " << p->requests
+            << " refs " << p->refs
+            << " readRequests " << p->readRequests
+            << " writeRequests " << p->writeRequests
+            << " readRefs " << p->readRefs
+            << " writeRefs " << p->writeRefs
+            << " writeRatio " << (p->refs ? (double)p->writeRefs / p->refs : 0.0)
+            << " distinctPages " << (long long)pages
+            << " footprintMB " << pages * 4 / 1024
+            << " distinctWrittenPages " << (long long)p->distinctWritten.estimate()
+            << " zipfAlpha " << p->zipfAlpha(ranked)
+            << " reqPagesHist";
+        for (int b = 0; b < Impl::SIZE_BUCKETS; b++) out << " " << p->sizeHist[b];
+        out << " reuseTimeHist";
+        for (int b = 0; b < Impl::REUSE_BUCKETS; b++) out << " " << (long long)p->reuseHist[b];
+        out << " topPages";
+        for (int i = 0; i < Impl::TOP_REPORTED && i < (int)ranked.size(); i++) {
+            out << " " << ranked[i].second << ":" << ranked[i].first;
+        }
+        out << " sketchBytes " << sketchBytes
+            << endl;
+    }
+}
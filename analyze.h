@@ -0,0 +1,36 @@
+#ifndef _analyze_H
+#define _analyze_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   One-pass trace characterization in constant memory, selected with
+   -m analyze. It is driven like a policy (every page reference goes
+   through refer()) and watches request boundaries as an observer.
+
+   Reports the read/write mix, a request-size histogram, distinct pages
+   (HyperLogLog), the heaviest pages (count-min sketch plus a top-k heap),
+   a Zipf exponent fitted to those, and a reuse-time histogram measured on
+   a hash-sampled subset of pages whose size is bounded.
+*/
+class TraceAnalyzer : public CachePolicy, public CacheObserver
+{
+public:
+    TraceAnalyzer();
+    ~TraceAnalyzer();
+
+    void refer(long long int addr, string rw);
+    void onRequest(long long int timestamp);
+
+    void report();
+    bool contains(long long int addr) { return false; }
+    long long int victim() { return -1; }
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
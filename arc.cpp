@@ -1,4 +1,5 @@
 #include "arc.h"
+#include "ghost.h"
 
 #include <list>
 #include <unordered_map>
@@ -6,26 +7,38 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <climits>
 
 using namespace std;
 
 struct ARCCache::Impl
 {
+    ARCCache* owner = nullptr;
+
     int c = 0;     // cache capacity (resident frames)
+    bool compactGhosts = false;
     int p = 0;     // target size for T1 (recency part)
+    int dirCap = 0;    // bound on T1+T2+B1+B2, 2c in the ARC paper
+    int ghostCap = 0;  // bound on each of B1 and B2, dirCap - c
+    double ghostFactor = 2.0;
 
     // Stats
     long long calls = 0;
     long long hits = 0;
     long long readHits = 0;
+    long long b1Hits = 0;      // misses found in a ghost list
+    long long b2Hits = 0;
     long long writeHits = 0;
     long long evictedDirtyPage = 0;
 
     // Lists (MRU at front, LRU at back)
-    list<long long> T1, T2, B1, B2;
+    list<long long> T1, T2;
 
     // Membership maps: key -> iterator
-    unordered_map<long long, list<long long>::iterator> posT1, posT2, posB1, posB2;
+    unordered_map<long long, list<long long>::iterator> posT1, posT2;
+
+    // Ghost lists, exact or compact fingerprints
+    GhostList B1, B2;
 
     // Dirty only for RESIDENT pages (T1/T2)
     unordered_set<long long> dirty;
@@ -70,65 +83,70 @@ struct ARCCache::Impl
 
     int szT1() const { return (int)T1.size(); }
     int szT2() const { return (int)T2.size(); }
-    int szB1() const { return (int)B1.size(); }
-    int szB2() const { return (int)B2.size(); }
+    int szB1() const { return B1.size(); }
+    int szB2() const { return B2.size(); }
 
     bool inT1(long long k) const { return posT1.find(k) != posT1.end(); }
     bool inT2(long long k) const { return posT2.find(k) != posT2.end(); }
-    bool inB1(long long k) const { return posB1.find(k) != posB1.end(); }
-    bool inB2(long long k) const { return posB2.find(k) != posB2.end(); }
+    bool inB1(long long k) const { return B1.contains(k); }
+    bool inB2(long long k) const { return B2.contains(k); }
 
     void markDirtyIfWrite(long long k, const string& rw) {
         if (isWriteOp(rw)) dirty.insert(k);
     }
 
-    void countDirtyEvictionIfNeeded(long long k) {
-        if (dirty.find(k) != dirty.end()) {
+    void countDirtyEvictionIfNeeded(long long k, int segment) {
+        bool wasDirty = dirty.find(k) != dirty.end();
+        if (wasDirty) {
             evictedDirtyPage++;
             dirty.erase(k);
         }
+        owner->notifyEvict(k, wasDirty, segment);
     }
 
     // ----- ARC core: REPLACE -----
     // Choose victim from T1 or T2 and move to corresponding ghost list.
+    // Only when the resident part is full: remove() takes pages out of
+    // T1/T2 without ghost entries, so the directory size alone overstates it
     void REPLACE(long long x)
     {
+        if (szT1() + szT2() < c) return;
         // If T1 has something and (T1 too big) OR (x is in B2 and T1 == p), evict from T1 -> B1
         if (!T1.empty() && (szT1() > p || (inB2(x) && szT1() == p))) {
             long long victim = popBack(T1, posT1);
             if (victim != -1) {
-                countDirtyEvictionIfNeeded(victim);
+                countDirtyEvictionIfNeeded(victim, SEG_T1);
                 // move to MRU of B1
-                pushFront(B1, posB1, victim);
+                B1.pushFront(victim);
             }
         } else {
             // else evict from T2 -> B2
             long long victim = popBack(T2, posT2);
             if (victim != -1) {
-                countDirtyEvictionIfNeeded(victim);
-                pushFront(B2, posB2, victim);
+                countDirtyEvictionIfNeeded(victim, SEG_T2);
+                B2.pushFront(victim);
             } else if (!T1.empty()) {
                 // fallback safety
                 victim = popBack(T1, posT1);
                 if (victim != -1) {
-                    countDirtyEvictionIfNeeded(victim);
-                    pushFront(B1, posB1, victim);
+                    countDirtyEvictionIfNeeded(victim, SEG_T1);
+                    B1.pushFront(victim);
                 }
             }
         }
     }
 
-    // Ensure ghost lists don’t exceed 2c total; ARC uses at most 2c ghost entries.
+    // Ensure ghost lists don’t exceed dirCap total; ARC uses at most 2c ghost entries.
     void trimGhostsIfNeeded()
     {
-        // Total tracked entries can grow to 2c (T1+T2+B1+B2 <= 2c ideally)
-        // ARC also trims B2 when total == 2c in the “new page” path.
+        // Total tracked entries can grow to dirCap (T1+T2+B1+B2 <= dirCap ideally)
+        // ARC also trims B2 when total == dirCap in the “new page” path.
         // Here: just keep B1 and B2 not insane.
-        while (szB1() > c) {
-            popBack(B1, posB1);
+        while (szB1() > ghostCap) {
+            B1.popBack();
         }
-        while (szB2() > c) {
-            popBack(B2, posB2);
+        while (szB2() > ghostCap) {
+            B2.popBack();
         }
     }
 
@@ -164,12 +182,13 @@ struct ARCCache::Impl
 
         // Case 2: k is in B1 (recently evicted from T1)
         if (inB1(k)) {
+            b1Hits++;
             int inc = max(1, (szB1() == 0 ? 1 : (szB2() / max(szB1(), 1))));
             p = min(c, p + inc);
 
             REPLACE(k);
             // move k from B1 to T2 (resident)
-            eraseFrom(B1, posB1, k);
+            B1.erase(k);
             pushFront(T2, posT2, k);
             markDirtyIfWrite(k, rw);
             return;
@@ -177,33 +196,39 @@ struct ARCCache::Impl
 
         // Case 3: k is in B2 (recently evicted from T2)
         if (inB2(k)) {
+            b2Hits++;
             int dec = max(1, (szB2() == 0 ? 1 : (szB1() / max(szB2(), 1))));
             p = max(0, p - dec);
 
             REPLACE(k);
-            eraseFrom(B2, posB2, k);
+            B2.erase(k);
             pushFront(T2, posT2, k);
             markDirtyIfWrite(k, rw);
             return;
         }
 
         // Case 4: k is new (not in any list)
-        // Follow ARC rules about balancing resident + ghosts.
-
         if (c <= 0) return; // degenerate
+        insertNew(k);
+        markDirtyIfWrite(k, rw);
+    }
 
-        // If |T1| + |B1| == c
-        if (szT1() + szB1() == c) {
+    // Follow ARC rules about balancing resident + ghosts, then put a page
+    // that is in no list at the MRU end of T1
+    void insertNew(long long k)
+    {
+        // If |T1| + |B1| == c; >= so that no state can miss both cases
+        if (szT1() + szB1() >= c) {
             if (szT1() < c) {
                 // evict LRU from B1, then REPLACE
-                popBack(B1, posB1);
+                B1.popBack();
                 REPLACE(k);
             } else {
-                // evict LRU from T1 directly -> B1
+                // B1 is empty: discard LRU of T1 without a ghost entry,
+                // otherwise |T1|+|B1| passes c and T1 grows unbounded
                 long long victim = popBack(T1, posT1);
                 if (victim != -1) {
-                    countDirtyEvictionIfNeeded(victim);
-                    pushFront(B1, posB1, victim);
+                    countDirtyEvictionIfNeeded(victim, SEG_T1);
                 }
             }
         }
@@ -211,9 +236,9 @@ struct ARCCache::Impl
         else if (szT1() + szB1() < c) {
             int total = szT1() + szT2() + szB1() + szB2();
             if (total >= c) {
-                if (total == 2 * c) {
+                if (total >= dirCap) {
                     // remove LRU from B2
-                    popBack(B2, posB2);
+                    B2.popBack();
                 }
                 REPLACE(k);
             }
@@ -221,17 +246,42 @@ struct ARCCache::Impl
 
         // Finally insert into T1 (recency list)
         pushFront(T1, posT1, k);
-        markDirtyIfWrite(k, rw);
 
         trimGhostsIfNeeded();
     }
+
+    // A prefetched page enters T1 as a new page. It was not referenced,
+    // so a ghost entry it may have is dropped without moving p
+    void prefetch(long long k)
+    {
+        if (inT1(k) || inT2(k) || c <= 0) return;
+        if (inB1(k)) B1.erase(k);
+        else if (inB2(k)) B2.erase(k);
+        insertNew(k);
+    }
+
+    // Ghost memory: what the compact tables take vs. exact lists at peak
+    void ghostStats(ostream& out) const
+    {
+        if (!compactGhosts) return;
+        out << " ghostMode compact"
+            << " ghostBytes " << (B1.bytes() + B2.bytes())
+            << " exactGhostBytes " << (size_t)(B1.peak() + B2.peak()) * GhostList::exactBytesPerEntry();
+    }
 };
 
-ARCCache::ARCCache(int size)
+ARCCache::ARCCache(int size, bool compactGhosts, double ghostFactor)
 {
     p = new Impl();
+    p->owner = this;
     p->c = max(0, size);
     p->p = 0;
+    p->compactGhosts = compactGhosts;
+    p->ghostFactor = ghostFactor;
+    p->dirCap = max(p->c, (int)(ghostFactor * p->c));
+    p->ghostCap = p->dirCap - p->c;
+    p->B1.init(p->ghostCap, compactGhosts);
+    p->B2.init(p->ghostCap, compactGhosts);
 }
 
 ARCCache::~ARCCache()
@@ -241,7 +291,70 @@ ARCCache::~ARCCache()
 
 void ARCCache::refer(long long int addr, string rw)
 {
+    long long before = p->hits;
     p->access(addr, rw);
+    notifyAccess(addr, Impl::isWriteOp(rw), p->hits != before);
+}
+
+void ARCCache::prefetch(long long int addr)
+{
+    p->prefetch(addr);
+}
+
+bool ARCCache::contains(long long int addr)
+{
+    return p->inT1(addr) || p->inT2(addr);
+}
+
+long long int ARCCache::victim()
+{
+    // REPLACE as seen by a brand-new page (not in B2)
+    if (p->szT1() + p->szT2() < p->c) return -1;
+    if (!p->T1.empty() && (p->szT1() > p->p || p->T2.empty())) return p->T1.back();
+    return p->T2.empty() ? -1 : p->T2.back();
+}
+
+void ARCCache::resize(int newSize)
+{
+    p->c = max(0, newSize);
+    p->p = min(p->p, p->c);
+    p->dirCap = max(p->c, (int)(p->ghostFactor * p->c));
+    p->ghostCap = p->dirCap - p->c;
+    // REPLACE for a page that is in neither ghost list
+    while (p->szT1() + p->szT2() > p->c) p->REPLACE(LLONG_MIN);
+    // restore |T1|+|B1| <= c and the directory bound, or the new-page
+    // path finds neither of its cases and inserts without evicting
+    while (p->szT1() + p->szB1() > p->c && p->szB1() > 0) p->B1.popBack();
+    while (p->szT1() + p->szT2() + p->szB1() + p->szB2() > p->dirCap && p->szB2() > 0) p->B2.popBack();
+    p->trimGhostsIfNeeded();
+}
+
+bool ARCCache::remove(long long int addr, bool& dirty)
+{
+    // leaves without a ghost entry: it was moved, not evicted
+    if (p->posT1.count(addr)) p->eraseFrom(p->T1, p->posT1, addr);
+    else if (p->posT2.count(addr)) p->eraseFrom(p->T2, p->posT2, addr);
+    else return false;
+    dirty = p->dirty.erase(addr) > 0;
+    return true;
+}
+
+void ARCCache::telemetryFields(vector<string>& names) const
+{
+    const char* fields[] = { "p", "T1", "T2", "B1", "B2", "b1Hits", "b2Hits" };
+    names.assign(fields, fields + 7);
+}
+
+void ARCCache::telemetry(vector<double>& values) const
+{
+    values.clear();
+    values.push_back(p->p);
+    values.push_back(p->szT1());
+    values.push_back(p->szT2());
+    values.push_back(p->szB1());
+    values.push_back(p->szB2());
+    values.push_back((double)p->b1Hits);
+    values.push_back((double)p->b2Hits);
 }
 
 void ARCCache::cacheHitsSummary()
@@ -255,6 +368,8 @@ void ARCCache::cacheHitsSummary()
     cout     << " writeHits " << p->writeHits << endl;
     cout     << " writeHitRatio " << (p->calls > 0 ? (double)p->writeHits / (double)p->calls : 0.0) << endl;
     cout     << " evictedDirtyPage " << p->evictedDirtyPage << endl;
+    p->ghostStats(cout);
+    if (p->compactGhosts) cout << endl;
 
     ofstream result("ExperimentalResult.txt", ios_base::app);
     if (result.is_open()) {
@@ -267,7 +382,9 @@ void ARCCache::cacheHitsSummary()
                << " readHitRatio " << (p->calls > 0 ? (double)p->readHits / (double)p->calls : 0.0) 
                << " writeHits " << p->writeHits 
                << " writeHitRatio " << (p->calls > 0 ? (double)p->writeHits / (double)p->calls : 0.0) 
-               << " evictedDirtyPage " << p->evictedDirtyPage << endl;
+               << " evictedDirtyPage " << p->evictedDirtyPage;
+        p->ghostStats(result);
+        result << endl;
         result.close();
     }
     result.close();
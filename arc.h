@@ -2,17 +2,30 @@
 #define _arc_H
 
 #include <string>
+#include "policy.h"
 using namespace std;
 
-class ARCCache
+class ARCCache : public CachePolicy
 {
 public:
-    ARCCache(int);
+    // compactGhosts: keep B1/B2 as fingerprint tables instead of exact lists
+    // ghostFactor: bound on resident plus ghost entries, in cache sizes
+    ARCCache(int, bool compactGhosts = false, double ghostFactor = 2.0);
     ~ARCCache();
 
     void refer(long long int addr, string rw);
+    void prefetch(long long int addr);
 
     void cacheHitsSummary();
+    bool contains(long long int addr);
+    long long int victim();
+    void report() { cacheHitsSummary(); }
+    bool remove(long long int addr, bool& dirty);
+    bool canRemove() const { return true; }
+    void resize(int newSize);
+    bool canResize() const { return true; }
+    void telemetryFields(vector<string>& names) const;
+    void telemetry(vector<double>& values) const;
 
 private:
     struct Impl;
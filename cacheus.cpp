@@ -18,18 +18,24 @@
     @brief: Constructor — initialize counters, capacities and heuristic defaults.
     @details: `historyCapacity` is set as 10% of the cache size by default.
     @param size: cache size in pages
+    @param compactGhosts: back the histories with fingerprint tables
+    @param historyFraction: history capacity as a share of the cache size
+    @param alpha: weight step applied on each regret history hit
 */
-CACHEUSCache::CACHEUSCache(int size)
+CACHEUSCache::CACHEUSCache(int size, bool compactGhosts, double historyFraction, double alpha)
     : capacity(size),
       calls(0), hits(0), readHits(0), writeHits(0), evictedDirtyPage(0),
       minFreq(1),
-      historyCapacity((int)std::ceil(size * 0.1)),
-      wA(0.5), wB(0.5)
+      historyCapacity((int)std::ceil(size * historyFraction)),
+      historyFraction(historyFraction),
+      compactGhosts(compactGhosts),
+      wA(0.5), wB(0.5), alpha(alpha),
+      lruHistoryHits(0), lfuHistoryHits(0)
 {
     // Reserve buckets to reduce rehash costs on large traces
     table.reserve((size_t)(capacity * 1.3) + 16);
-    lruHistoryIter.reserve((size_t)(historyCapacity * 1.3) + 16);
-    lfuHistoryIter.reserve((size_t)(historyCapacity * 1.3) + 16);
+    lruHistory.init(historyCapacity, compactGhosts);
+    lfuHistory.init(historyCapacity, compactGhosts);
     freqBuckets.reserve(128);
 }
 
@@ -186,41 +192,63 @@ long long CACHEUSCache::chooseVictimLFU() {
     return it->second.front();
 }
 
+/*!
+    @brief: Peek at the page the next miss would evict.
+    @details: Mirrors evictAndInsert(): the favored expert picks the victim.
+    @return: address of the victim page, or -1 while the cache has room
+*/
+long long CACHEUSCache::victim() {
+    if ((int)table.size() < capacity) return -1;
+    return (wA >= wB) ? chooseVictimLRU() : chooseVictimLFU();
+}
+
+/*!
+    @brief: Take a resident page out of both experts without an eviction.
+    @details: Used to move pages between cache tiers; no regret is recorded.
+    @param addr: page address to remove
+    @param dirty: receives the page's dirty bit
+    @return: false if the page was not resident
+*/
+bool CACHEUSCache::remove(long long addr, bool &dirty) {
+    auto it = table.find(addr);
+    if (it == table.end()) return false;
+
+    PageInfo &info = it->second;
+    dirty = info.dirty;
+    lruList.erase(info.lruIter);
+    int oldFreq = info.freq;
+    removeFromFreqBucket(addr, info);
+    table.erase(it);
+    // with no pages left there is no bucket for minFreq to find
+    if (!table.empty()) fixMinFreqAfterRemoval(oldFreq);
+    return true;
+}
+
 /*!
     @brief: Record an evicted victim into the LRU regret/history (expert A).
-    @details: Keeps history bounded and stores iterators for O(1) removal.
+    @details: Keeps history bounded; GhostList gives O(1) removal.
     @param victim: address of the evicted page
 */
 void CACHEUSCache::addToHistoryA(long long victim) {
-    auto it = lruHistoryIter.find(victim);
-    if (it != lruHistoryIter.end()) lruHistory.erase(it->second);
-
-    lruHistory.push_front(victim);
-    lruHistoryIter[victim] = lruHistory.begin();
+    lruHistory.erase(victim);
+    lruHistory.pushFront(victim);
 
-    while ((int)lruHistory.size() > historyCapacity) {
-        long long old = lruHistory.back();
-        lruHistory.pop_back();
-        lruHistoryIter.erase(old);
+    while (lruHistory.size() > historyCapacity) {
+        lruHistory.popBack();
     }
 }
 
 /*!
     @brief: Record an evicted victim into the LFU regret/history (expert B).
-    @details: Keeps history bounded and stores iterators for O(1) removal.
+    @details: Keeps history bounded; GhostList gives O(1) removal.
     @param victim: address of the evicted page
 */
 void CACHEUSCache::addToHistoryB(long long victim) {
-    auto it = lfuHistoryIter.find(victim);
-    if (it != lfuHistoryIter.end()) lfuHistory.erase(it->second);
+    lfuHistory.erase(victim);
+    lfuHistory.pushFront(victim);
 
-    lfuHistory.push_front(victim);
-    lfuHistoryIter[victim] = lfuHistory.begin();
-
-    while ((int)lfuHistory.size() > historyCapacity) {
-        long long old = lfuHistory.back();
-        lfuHistory.pop_back();
-        lfuHistoryIter.erase(old);
+    while (lfuHistory.size() > historyCapacity) {
+        lfuHistory.popBack();
     }
 }
 
@@ -231,28 +259,16 @@ void CACHEUSCache::addToHistoryB(long long victim) {
     @param addr: address of the missed page
 */
 void CACHEUSCache::updateWeightsFromHistory(long long addr) {
-    bool inA = false, inB = false;
-
-    auto itA = lruHistoryIter.find(addr);
-    if (itA != lruHistoryIter.end()) {
-        inA = true;
-        lruHistory.erase(itA->second);
-        lruHistoryIter.erase(itA);
-    }
-
-    auto itB = lfuHistoryIter.find(addr);
-    if (itB != lfuHistoryIter.end()) {
-        inB = true;
-        lfuHistory.erase(itB->second);
-        lfuHistoryIter.erase(itB);
-    }
+    bool inA = lruHistory.erase(addr);
+    bool inB = lfuHistory.erase(addr);
 
-    const double alpha = 0.1;
     if (inA && !inB) {
+        lruHistoryHits++;
         // Favor LRU slightly
         wA = std::max(0.0, wA - alpha);
         wB = 1.0 - wA;
     } else if (inB && !inA) {
+        lfuHistoryHits++;
         // Favor LFU slightly
         wB = std::max(0.0, wB - alpha);
         wA = 1.0 - wB;
@@ -261,26 +277,32 @@ void CACHEUSCache::updateWeightsFromHistory(long long addr) {
 
 /*!
     @brief: Evict a victim (by favored expert) and insert a new page.
-    @details: Updates dirty-eviction counts, removes entries from both experts,
-                     records regret, and inserts the new page.
     @param addr: page address being inserted
     @param rwtype: read/write operation type
 */
 void CACHEUSCache::evictAndInsert(long long addr, const string &rwtype) {
     if (capacity <= 0) return;
 
+    evictOne();
+    insertNewPage(addr, rwtype);
+}
+
+/*!
+    @brief: Evict the victim of the favored expert.
+    @details: Updates dirty-eviction counts, removes entries from both experts
+                     and records regret.
+*/
+void CACHEUSCache::evictOne() {
     bool useLRU = (wA >= wB);
     long long victim = useLRU ? chooseVictimLRU() : chooseVictimLFU();
-    if (victim == -1) {
-        insertNewPage(addr, rwtype);
-        return;
-    }
+    if (victim == -1) return;
 
     auto vit = table.find(victim);
     if (vit != table.end()) {
         PageInfo &vinfo = vit->second;
 
         if (vinfo.dirty) evictedDirtyPage++;
+        notifyEvict(victim, vinfo.dirty, useLRU ? SEG_LRU : SEG_LFU);
 
         // Remove from global LRU
         lruList.erase(vinfo.lruIter);
@@ -297,8 +319,19 @@ void CACHEUSCache::evictAndInsert(long long addr, const string &rwtype) {
     // Record regret history
     if (useLRU) addToHistoryA(victim);
     else        addToHistoryB(victim);
+}
 
-    insertNewPage(addr, rwtype);
+/*!
+    @brief: Change the capacity, evicting by the favored expert to shrink.
+    @details: The histories keep their share of the cache.
+    @param newSize: new capacity in pages
+*/
+void CACHEUSCache::resize(int newSize) {
+    capacity = std::max(0, newSize);
+    historyCapacity = (int)std::ceil(capacity * historyFraction);
+    while ((int)table.size() > capacity) evictOne();
+    while (lruHistory.size() > historyCapacity) lruHistory.popBack();
+    while (lfuHistory.size() > historyCapacity) lfuHistory.popBack();
 }
 
 /*!
@@ -319,6 +352,7 @@ void CACHEUSCache::refer(long long int addr, string rwtype) {
         else if (isRead(rwtype)) readHits++;
 
         touchPage(addr, rwtype);
+        notifyAccess(addr, isWrite(rwtype), true);
         return;
     }
 
@@ -327,6 +361,30 @@ void CACHEUSCache::refer(long long int addr, string rwtype) {
 
     if ((int)table.size() < capacity) insertNewPage(addr, rwtype);
     else evictAndInsert(addr, rwtype);
+    notifyAccess(addr, isWrite(rwtype), false);
+}
+
+/*!
+    @brief: Column names of the telemetry record.
+*/
+void CACHEUSCache::telemetryFields(vector<string>& names) const {
+    const char* fields[] = { "wA", "wB", "lruHistory", "lfuHistory", "lruHistoryHits", "lfuHistoryHits" };
+    names.assign(fields, fields + 6);
+}
+
+/*!
+    @brief: Expert weights, history sizes and cumulative history hits.
+    @details: A hit in the LRU history means LRU evicted a page too early,
+                     so it moves weight towards LFU, and the other way round.
+*/
+void CACHEUSCache::telemetry(vector<double>& values) const {
+    values.clear();
+    values.push_back(wA);
+    values.push_back(wB);
+    values.push_back(lruHistory.size());
+    values.push_back(lfuHistory.size());
+    values.push_back((double)lruHistoryHits);
+    values.push_back((double)lfuHistoryHits);
 }
 
 /*!
@@ -339,6 +397,10 @@ void CACHEUSCache::cacheHits() {
     std::cout << "Read Hits: " << readHits << std::endl;
     std::cout << "Write Hits: " << writeHits << std::endl;
     std::cout << "Evicted Dirty Pages: " << evictedDirtyPage << std::endl;
+    if (compactGhosts) {
+        std::cout << "Ghost Bytes: " << (lruHistory.bytes() + lfuHistory.bytes()) << std::endl;
+        std::cout << "Exact Ghost Bytes: " << (size_t)(lruHistory.peak() + lfuHistory.peak()) * GhostList::exactBytesPerEntry() << std::endl;
+    }
 
     std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
     if (result.is_open()) {
@@ -349,7 +411,12 @@ void CACHEUSCache::cacheHits() {
          "Hit Rate: " << (static_cast<double>(hits) / calls) * 100 << "%" << 
          "Read Hits: " << readHits << 
          "Write Hits: " << writeHits << 
-         "Evicted Dirty Pages: " << evictedDirtyPage << std::endl;
+         "Evicted Dirty Pages: " << evictedDirtyPage;
+        if (compactGhosts) {
+            result << "Ghost Bytes: " << (lruHistory.bytes() + lfuHistory.bytes()) <<
+             "Exact Ghost Bytes: " << (size_t)(lruHistory.peak() + lfuHistory.peak()) * GhostList::exactBytesPerEntry();
+        }
+        result << std::endl;
         result.close();
     }
 
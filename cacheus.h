@@ -6,16 +6,30 @@
 #include <list>
 #include <unordered_map>
 #include <string>
+#include "policy.h"
+#include "ghost.h"
 
 using namespace std;
 
-class CACHEUSCache {
+class CACHEUSCache : public CachePolicy {
 public:
-    CACHEUSCache(int);
+    // compactGhosts: keep the regret histories as fingerprint tables
+    // historyFraction: size of each history as a share of the cache
+    // alpha: weight moved towards an expert per history hit
+    CACHEUSCache(int, bool compactGhosts = false, double historyFraction = 0.1, double alpha = 0.1);
     ~CACHEUSCache();
 
     void refer(long long int addr, string rwtype);
     void cacheHits();
+    void report() { cacheHits(); }
+    bool contains(long long int addr) { return table.find(addr) != table.end(); }
+    long long int victim();
+    bool remove(long long int addr, bool& dirty);
+    bool canRemove() const { return true; }
+    void resize(int newSize);
+    bool canResize() const { return true; }
+    void telemetryFields(vector<string>& names) const;
+    void telemetry(vector<double>& values) const;
 
 private:
     int capacity;
@@ -40,19 +54,22 @@ private:
     std::unordered_map<long long, PageInfo> table;
 
     // Histories
-    std::list<long long> lruHistory;
-    std::list<long long> lfuHistory;
-    std::unordered_map<long long, std::list<long long>::iterator> lruHistoryIter;
-    std::unordered_map<long long, std::list<long long>::iterator> lfuHistoryIter;
+    GhostList lruHistory;
+    GhostList lfuHistory;
     int historyCapacity;
+    double historyFraction;
+    bool compactGhosts;
 
     // Expert weights
     double wA, wB;
+    double alpha;
+    long long lruHistoryHits, lfuHistoryHits;   // misses found in one history only
 
     // Helpers
     void touchPage(long long addr, const string &rwtype);
     void insertNewPage(long long addr, const string &rwtype);
     void evictAndInsert(long long addr, const string &rwtype);
+    void evictOne();
 
     long long chooseVictimLRU() const;
     long long chooseVictimLFU(); // updates minFreq if needed
@@ -0,0 +1,176 @@
+#include "device.h"
+
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const long long PAGE = 4 * 1024;
+
+// Latency histogram buckets grow by 10%: bucket k covers [base*g^k, base*g^(k+1))
+static const double HIST_BASE_US = 0.5;
+static const double HIST_GROWTH = 1.1;
+static const int HIST_BUCKETS = 256;
+
+bool DeviceProfile::byName(const string& name, DeviceProfile& out)
+{
+    if (name == "SSD") {
+        DeviceProfile d = { "SSD", 80.0, 500.0, 32, 1.0 };
+        out = d;
+        return true;
+    }
+    if (name == "HDD") {
+        DeviceProfile d = { "HDD", 8000.0, 150.0, 1, 1.0 };
+        out = d;
+        return true;
+    }
+    return false;
+}
+
+struct DeviceModel::Impl
+{
+    DeviceProfile dev;
+    double pageUs = 0;          // transfer time of one 4KB page
+
+    vector<double> channelFree; // time each queue slot becomes idle
+    long long headPos = -1;     // end of the last backend operation
+
+    long long firstTs = -1;
+    double reqArrival = 0;
+    double reqDone = 0;         // completion of the slowest page so far
+    double reqCpu = 0;          // serial hit service time
+    bool open = false;
+    double lastDone = 0;
+
+    long long requests = 0;
+    long long backendReads = 0;
+    long long backendWrites = 0;
+    long long seqOps = 0;
+    double busyUs = 0;
+    double latencySum = 0;
+    double maxLatency = 0;
+    long long hist[HIST_BUCKETS] = { 0 };
+
+    // Queue one 4KB operation at time t, return its completion
+    double submit(long long addr, double t) {
+        bool seq = (addr == headPos);
+        if (seq) seqOps++;
+        double service = (seq ? 0.0 : dev.seekUs) + pageUs;
+        headPos = addr + PAGE;
+
+        auto ch = min_element(channelFree.begin(), channelFree.end());
+        double start = max(t, *ch);
+        *ch = start + service;
+        busyUs += service;
+        return *ch;
+    }
+
+    void closeRequest() {
+        if (!open) return;
+        open = false;
+        double lat = max(reqDone, reqArrival + reqCpu) - reqArrival;
+        lastDone = reqArrival + lat;
+        requests++;
+        latencySum += lat;
+        maxLatency = max(maxLatency, lat);
+        int b = 0;
+        if (lat > HIST_BASE_US) b = (int)(log(lat / HIST_BASE_US) / log(HIST_GROWTH));
+        hist[min(max(b, 0), HIST_BUCKETS - 1)]++;
+    }
+
+    void request(long long ts) {
+        closeRequest();
+        if (ts < 0) {
+            // no timestamps: closed loop, next request when this one is done
+            reqArrival = lastDone;
+        } else {
+            if (firstTs < 0) firstTs = ts;
+            reqArrival = (ts - firstTs) / 10.0;   // 100ns units -> us
+        }
+        reqDone = reqArrival;
+        reqCpu = 0;
+        open = true;
+    }
+
+    double percentile(double q) const {
+        long long target = (long long)ceil(q * requests);
+        long long seen = 0;
+        for (int b = 0; b < HIST_BUCKETS; b++) {
+            seen += hist[b];
+            if (seen >= target && seen > 0) return HIST_BASE_US * pow(HIST_GROWTH, b + 1);
+        }
+        return maxLatency;
+    }
+};
+
+DeviceModel::DeviceModel(const DeviceProfile& profile)
+{
+    p = new Impl();
+    p->dev = profile;
+    p->pageUs = (double)PAGE / (profile.transferMBps * 1024 * 1024) * 1e6;
+    p->channelFree.assign(max(1, profile.queueDepth), 0.0);
+}
+
+DeviceModel::~DeviceModel()
+{
+    delete p;
+}
+
+void DeviceModel::onRequest(long long int timestamp)
+{
+    p->request(timestamp);
+}
+
+void DeviceModel::onEvict(long long int addr, bool dirty)
+{
+    // write-back is asynchronous: it occupies the device but the request does not wait
+    if (!dirty) return;
+    if (!p->open) p->request(-1);
+    p->backendWrites++;
+    p->submit(addr, p->reqArrival);
+}
+
+void DeviceModel::onAccess(long long int addr, bool write, bool hit)
+{
+    if (!p->open) p->request(-1);
+    p->reqCpu += p->dev.hitUs;
+    // write misses are absorbed by the cache, read misses go to the device
+    if (hit || write) return;
+    p->backendReads++;
+    p->reqDone = max(p->reqDone, p->submit(addr, p->reqArrival));
+}
+
+void DeviceModel::finish()
+{
+    p->closeRequest();
+}
+
+void DeviceModel::report(const string& policy, int csize)
+{
+    double makespan = 0;
+    for (size_t i = 0; i < p->channelFree.size(); i++) makespan = max(makespan, p->channelFree[i]);
+    makespan = max(makespan, p->lastDone);
+    double util = makespan > 0 ? p->busyUs / (makespan * p->channelFree.size()) : 0.0;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "Device " << policy
+            << " " << p->dev.name
+            << " CacheSize " << csize
+            << " requests " << p->requests
+            << " meanLatencyUs " << (p->requests > 0 ? p->latencySum / p->requests : 0.0)
+            << " p99LatencyUs " << p->percentile(0.99)
+            << " maxLatencyUs " << p->maxLatency
+            << " backendReads " << p->backendReads
+            << " backendWrites " << p->backendWrites
+            << " sequentialOps " << p->seqOps
+            << " utilization " << util
+            << endl;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef _device_H
+#define _device_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+// Cost parameters of a backing device
+struct DeviceProfile
+{
+    string name;
+    double seekUs;        // positioning cost paid by a non-sequential access
+    double transferMBps;  // streaming bandwidth
+    int queueDepth;       // backend operations serviced in parallel
+    double hitUs;         // service time of a cache hit
+
+    // "SSD" or "HDD"; returns false for an unknown name
+    static bool byName(const string& name, DeviceProfile& out);
+};
+
+/*
+   Latency model fed by a policy's hits, misses and evictions. Requests
+   arrive at their trace timestamps; read misses and dirty evictions become
+   4KB backend operations queued on queueDepth channels. An access that
+   continues where the previous backend operation ended skips the seek.
+   A request completes when its last page is served. Reports mean and p99
+   request latency and backend utilization.
+*/
+class DeviceModel : public CacheObserver
+{
+public:
+    DeviceModel(const DeviceProfile& profile);
+    ~DeviceModel();
+
+    void onEvict(long long int addr, bool dirty);
+    void onAccess(long long int addr, bool write, bool hit);
+    void onRequest(long long int timestamp);
+
+    // close the last open request
+    void finish();
+
+    void report(const string& policy, int csize);
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,348 @@
+#include "eventlog.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+
+using namespace std;
+
+static const char MAGIC[4] = { 'C', 'E', 'V', 'T' };
+static const unsigned char VERSION = 1;
+static const size_t BUFFER = 1 << 20;
+static const int INLINE_EVICTIONS = 63;     // larger counts follow as a varint
+
+static inline uint64_t zigzag(long long v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline long long unzigzag(uint64_t v)
+{
+    return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+// MSR keys are byte offsets of 512-byte sectors, so most deltas divide
+// by 512 and lose 9 bits; the low bit tells whether the delta was scaled
+static const long long SECTOR = 512;
+
+static inline uint64_t packDelta(long long delta)
+{
+    if (delta % SECTOR == 0) return zigzag(delta / SECTOR) << 1;
+    return zigzag(delta) << 1 | 1;
+}
+
+static inline long long unpackDelta(uint64_t v)
+{
+    if (v & 1) return unzigzag(v >> 1);
+    return unzigzag(v >> 1) * SECTOR;
+}
+
+static inline char* putVarint(char* out, uint64_t v)
+{
+    while (v >= 0x80) {
+        *out++ = (char)(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = (char)v;
+    return out;
+}
+
+struct EventLogWriter::Impl
+{
+    FILE* file = nullptr;
+    string policy;
+    int csize = 0;
+
+    // the simulation fills bufs[cur]; a full buffer is handed to the
+    // writer thread, which owns it until it clears pending
+    vector<char> bufs[2];
+    int cur = 0;
+    size_t len = 0;
+    mutex m;
+    condition_variable cv;
+    bool pending = false;
+    size_t pendingLen = 0;
+    bool closing = false;
+    thread writer;
+    bool finished = false;
+
+    // evictions seen since the last onAccess, written with that reference
+    struct Eviction { long long key; unsigned char tag; };
+    vector<Eviction> evictions;
+    long long lastKey = 0;
+    long long lastVictim = 0;
+
+    long long refs = 0;
+    long long evicted = 0;
+    long long bytes = 0;
+    long long writeErrors = 0;
+
+    void writeLoop() {
+        unique_lock<mutex> lock(m);
+        for (;;) {
+            cv.wait(lock, [this] { return pending || closing; });
+            if (!pending) break;
+            const vector<char>& b = bufs[cur ^ 1];
+            size_t n = pendingLen;
+            lock.unlock();
+            if (fwrite(b.data(), 1, n, file) != n) writeErrors++;
+            lock.lock();
+            pending = false;
+            cv.notify_all();
+        }
+    }
+
+    // hand the current buffer over, waiting if the previous one is
+    // still being written
+    void swap() {
+        unique_lock<mutex> lock(m);
+        cv.wait(lock, [this] { return !pending; });
+        pending = true;
+        pendingLen = len;
+        cur ^= 1;
+        len = 0;
+        cv.notify_all();
+    }
+
+    void put(const void* data, size_t n) {
+        memcpy(&bufs[cur][len], data, n);
+        len += n;
+        bytes += n;
+    }
+};
+
+EventLogWriter::EventLogWriter(const string& path, const string& policy, int csize)
+{
+    p = new Impl();
+    p->policy = policy;
+    p->csize = csize;
+    p->file = fopen(path.c_str(), "wb");
+    if (!p->file) return;
+
+    p->bufs[0].resize(BUFFER);
+    p->bufs[1].resize(BUFFER);
+    char header[32];
+    char* h = header;
+    memcpy(h, MAGIC, 4);
+    h += 4;
+    *h++ = (char)VERSION;
+    h = putVarint(h, (uint64_t)max(csize, 0));
+    h = putVarint(h, policy.size());
+    p->put(header, h - header);
+    p->put(policy.data(), policy.size());
+    p->writer = thread(&Impl::writeLoop, p);
+}
+
+EventLogWriter::~EventLogWriter()
+{
+    finish();
+    delete p;
+}
+
+bool EventLogWriter::ok() const
+{
+    return p->file != nullptr;
+}
+
+void EventLogWriter::onEvictFrom(long long int addr, bool dirty, int segment)
+{
+    if (!p->file) return;
+    Impl::Eviction e = { addr, (unsigned char)(segment << 1 | (dirty ? 1 : 0)) };
+    p->evictions.push_back(e);
+}
+
+void EventLogWriter::onAccess(long long int addr, bool write, bool hit)
+{
+    if (!p->file || p->finished) return;
+
+    size_t n = p->evictions.size();
+    if (n * 11 > BUFFER / 2) {
+        // pathological burst of evictions, keep the reference only
+        n = 0;
+        p->evictions.clear();
+    }
+    // flags, the count escape and the key, then a tag and a varint per eviction
+    size_t worst = 1 + 10 + 10 + n * 11;
+    if (p->len + worst > BUFFER) p->swap();
+
+    char* start = &p->bufs[p->cur][p->len];
+    char* out = start;
+    int inlineCount = n < (size_t)INLINE_EVICTIONS ? (int)n : INLINE_EVICTIONS;
+    *out++ = (char)((hit ? 1 : 0) | (write ? 2 : 0) | inlineCount << 2);
+    if (inlineCount == INLINE_EVICTIONS) out = putVarint(out, n);
+    out = putVarint(out, packDelta(addr - p->lastKey));
+    p->lastKey = addr;
+    for (size_t i = 0; i < n; i++) {
+        *out++ = (char)p->evictions[i].tag;
+        out = putVarint(out, packDelta(p->evictions[i].key - p->lastVictim));
+        p->lastVictim = p->evictions[i].key;
+    }
+    p->evictions.clear();
+
+    p->len += out - start;
+    p->bytes += out - start;
+    p->refs++;
+    p->evicted += n;
+}
+
+void EventLogWriter::finish()
+{
+    if (!p->file || p->finished) return;
+    p->finished = true;
+    if (p->len > 0) p->swap();
+    {
+        lock_guard<mutex> lock(p->m);
+        p->closing = true;
+        p->cv.notify_all();
+    }
+    p->writer.join();
+    fclose(p->file);
+}
+
+void EventLogWriter::report()
+{
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "EventLog " << p->policy
+            << " CacheSize " << p->csize
+            << " refs " << p->refs
+            << " evictions " << p->evicted
+            << " bytes " << p->bytes
+            << " bytesPerRef " << (p->refs ? (double)p->bytes / p->refs : 0.0)
+            << " writeErrors " << p->writeErrors
+            << endl;
+    }
+}
+
+// Buffered reader over the log file for the dump
+class EventLogReader
+{
+public:
+    EventLogReader(FILE* f) : file(f), buf(BUFFER), pos(0), len(0) {}
+
+    bool byte(unsigned char& c) {
+        if (pos == len) {
+            len = fread(buf.data(), 1, buf.size(), file);
+            pos = 0;
+            if (len == 0) return false;
+        }
+        c = (unsigned char)buf[pos++];
+        return true;
+    }
+
+    bool varint(uint64_t& v) {
+        v = 0;
+        unsigned char c;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (!byte(c)) return false;
+            v |= (uint64_t)(c & 0x7F) << shift;
+            if (!(c & 0x80)) return true;
+        }
+        return false;
+    }
+
+private:
+    FILE* file;
+    vector<char> buf;
+    size_t pos, len;
+};
+
+int dumpEventLog(const char* path)
+{
+    bool piped = strcmp(path, "-") == 0;
+    FILE* f = piped ? stdin : fopen(path, "rb");
+    if (!f) {
+        cerr << "error: unable to open event log " << path << endl;
+        return -1;
+    }
+    EventLogReader in(f);
+
+    char magic[4];
+    unsigned char c;
+    bool good = true;
+    for (int i = 0; i < 4 && good; i++) {
+        good = in.byte(c);
+        magic[i] = (char)c;
+    }
+    unsigned char version = 0;
+    uint64_t csize = 0, nameLen = 0;
+    good = good && memcmp(magic, MAGIC, 4) == 0 && in.byte(version) && version == VERSION
+        && in.varint(csize) && in.varint(nameLen) && nameLen < 256;
+    string policy;
+    for (uint64_t i = 0; good && i < nameLen; i++) {
+        good = in.byte(c);
+        policy += (char)c;
+    }
+    if (!good) {
+        cerr << "error: " << path << " is not an event log" << endl;
+        if (!piped) fclose(f);
+        return -1;
+    }
+
+    long long refs = 0, hits = 0, writes = 0, evictions = 0, dirtyEvictions = 0;
+    long long bySegment[SEG_COUNT] = { 0 };
+    long long dirtyBySegment[SEG_COUNT] = { 0 };
+    long long key = 0, victim = 0;
+    bool truncated = false;
+    unsigned char flags;
+    while (in.byte(flags)) {
+        uint64_t n = flags >> 2, delta;
+        if (n == (uint64_t)INLINE_EVICTIONS && !in.varint(n)) { truncated = true; break; }
+        if (!in.varint(delta)) { truncated = true; break; }
+        key += unpackDelta(delta);
+        bool hit = flags & 1, write = (flags & 2) != 0;
+        refs++;
+        if (hit) hits++;
+        if (write) writes++;
+        printf("%lld %s %c %lld", refs - 1, hit ? "hit" : "miss", write ? 'W' : 'R', key);
+        for (uint64_t i = 0; i < n; i++) {
+            unsigned char tag;
+            if (!in.byte(tag) || !in.varint(delta)) { truncated = true; break; }
+            victim += unpackDelta(delta);
+            int segment = tag >> 1;
+            bool dirty = tag & 1;
+            evictions++;
+            if (dirty) dirtyEvictions++;
+            if (segment < SEG_COUNT) {
+                bySegment[segment]++;
+                if (dirty) dirtyBySegment[segment]++;
+            }
+            printf(" evict %lld %s%s", victim, segmentName(segment), dirty ? " dirty" : "");
+        }
+        printf("\n");
+        if (truncated) break;
+    }
+    if (!piped) fclose(f);
+    if (truncated) cerr << "warning: " << path << " ends inside a record" << endl;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "EventDump " << policy
+            << " CacheSize " << csize
+            << " refs " << refs
+            << " hits " << hits
+            << " hitRatio " << (refs ? (double)hits / refs : 0.0)
+            << " writes " << writes
+            << " evictions " << evictions
+            << " dirtyEvictions " << dirtyEvictions;
+        for (int s = 0; s < SEG_COUNT; s++) {
+            if (bySegment[s] == 0) continue;
+            out << " " << segmentName(s) << " " << bySegment[s] << "/" << dirtyBySegment[s];
+        }
+        out << endl;
+    }
+    return 0;
+}
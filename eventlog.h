@@ -0,0 +1,53 @@
+#ifndef _eventlog_H
+#define _eventlog_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   Binary log of every reference: hit or miss, read or write, and the
+   pages it evicted with their dirty bit and EvictSegment. Keys are
+   varints of the delta to the previous key (victims to the previous
+   victim), zigzag encoded and divided by 512 when they are sector
+   aligned, so a MSR reference costs about 2 bytes and an eviction about
+   4 more. Records fill one buffer while a background thread writes the
+   other.
+
+   File: "CEVT", version byte, varint cache size, varint name length and
+   the policy name, then one record per reference:
+     flags     bit0 hit, bit1 write, bits2-7 eviction count (63: a varint
+               with the real count follows)
+     varint    delta(key - previous key)
+     per eviction:
+       byte    segment << 1 | dirty
+       varint  delta(victim - previous victim)
+   where delta(d) is zigzag(d / 512) << 1 for multiples of 512 and
+   zigzag(d) << 1 | 1 otherwise.
+*/
+class EventLogWriter : public CacheObserver
+{
+public:
+    EventLogWriter(const string& path, const string& policy, int csize);
+    ~EventLogWriter();
+
+    bool ok() const;
+
+    void onEvict(long long int addr, bool dirty) { onEvictFrom(addr, dirty, SEG_NONE); }
+    void onEvictFrom(long long int addr, bool dirty, int segment);
+    void onAccess(long long int addr, bool write, bool hit);
+
+    // write out the last buffer and close the file
+    void finish();
+
+    void report();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+// -m dump: print the events of a log and a summary by segment
+int dumpEventLog(const char* path);
+
+#endif
@@ -0,0 +1,372 @@
+#include "extent.h"
+
+#include <list>
+#include <map>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+struct Piece
+{
+    long long start;
+    long long end;
+    int which;
+    bool dirty;
+};
+
+// Non-overlapping extents keyed by start offset. Every extent also sits in
+// one of several recency lists (MRU at front, LRU at back); the lists store
+// start offsets and the map stores the list position, so both directions
+// are O(1) after the O(log n) interval lookup.
+class ExtentMap
+{
+public:
+    explicit ExtentMap(int nlists) : lists(nlists), bytes(nlists, 0) {}
+
+    long long size(int l) const { return bytes[l]; }
+    bool empty(int l) const { return lists[l].empty(); }
+    size_t extents() const { return m.size(); }
+
+    // Remove every byte of [a, b) from the map and return the removed pieces
+    // in offset order. Extents straddling a or b are split first.
+    void carve(long long a, long long b, vector<Piece>& out)
+    {
+        out.clear();
+        splitAt(a);
+        splitAt(b);
+        auto it = m.lower_bound(a);
+        while (it != m.end() && it->first < b) {
+            Extent& e = it->second;
+            Piece pc = { it->first, e.end, e.which, e.dirty };
+            out.push_back(pc);
+            lists[e.which].erase(e.pos);
+            bytes[e.which] -= e.end - it->first;
+            it = m.erase(it);
+        }
+    }
+
+    // Insert the free range [a, b) at the MRU end of list l. If the current
+    // MRU extent of that list is adjacent with the same dirty state, the two
+    // are merged instead of creating a new entry.
+    void insertFront(long long a, long long b, int l, bool dirty)
+    {
+        if (a >= b) return;
+        list<long long>& L = lists[l];
+        bytes[l] += b - a;
+
+        auto right = m.lower_bound(a);
+        if (right != m.begin()) {
+            Extent& e = std::prev(right)->second;
+            if (e.end == a && e.which == l && e.dirty == dirty && e.pos == L.begin()) {
+                e.end = b;
+                return;
+            }
+        }
+        if (right != m.end() && right->first == b) {
+            Extent e = right->second;
+            if (e.which == l && e.dirty == dirty && e.pos == L.begin()) {
+                *e.pos = a;
+                m.erase(right);
+                m.insert(make_pair(a, e));
+                return;
+            }
+        }
+
+        L.push_front(a);
+        Extent e = { b, l, dirty, L.begin() };
+        m.insert(make_pair(a, e));
+    }
+
+    // Drop the LRU extent of list l.
+    bool popBack(int l, Piece& out)
+    {
+        list<long long>& L = lists[l];
+        if (L.empty()) return false;
+        auto it = m.find(L.back());
+        out.start = it->first;
+        out.end = it->second.end;
+        out.which = l;
+        out.dirty = it->second.dirty;
+        bytes[l] -= out.end - out.start;
+        L.pop_back();
+        m.erase(it);
+        return true;
+    }
+
+private:
+    struct Extent {
+        long long end;
+        int which;
+        bool dirty;
+        list<long long>::iterator pos;
+    };
+
+    map<long long, Extent> m;
+    vector<list<long long> > lists;
+    vector<long long> bytes;
+
+    // Make x an extent boundary. The right half keeps the recency of the
+    // original extent: it is linked directly behind the left half.
+    void splitAt(long long x)
+    {
+        auto it = m.upper_bound(x);
+        if (it == m.begin()) return;
+        --it;
+        if (it->first >= x || it->second.end <= x) return;
+
+        Extent right = it->second;
+        right.pos = lists[right.which].insert(std::next(it->second.pos), x);
+        it->second.end = x;
+        m.insert(make_pair(x, right));
+    }
+};
+
+struct ExtentStats
+{
+    long long calls = 0;
+    long long bytes = 0;
+    long long hitBytes = 0;
+    long long readHitBytes = 0;
+    long long writeHitBytes = 0;
+    long long evictedDirtyBytes = 0;
+    size_t maxExtents = 0;
+
+    void print(ostream& out, const char* name, long long capacity, size_t extents) const
+    {
+        out << name
+            << " CacheBytes " << capacity
+            << " calls " << calls
+            << " bytes " << bytes
+            << " hitBytes " << hitBytes
+            << " byteHitRatio " << (bytes > 0 ? (double)hitBytes / (double)bytes : 0.0)
+            << " readHitBytes " << readHitBytes
+            << " writeHitBytes " << writeHitBytes
+            << " evictedDirtyBytes " << evictedDirtyBytes
+            << " extents " << extents
+            << " maxExtents " << maxExtents;
+    }
+};
+
+static bool isWriteOp(const string& rw) {
+    return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+}
+
+// Put [a, b) back after carve(): pieces that were found in the map go to
+// hitList(piece.which), the gaps between them are new data for missList.
+// Only the last `cap` bytes are kept when the request is bigger than the
+// cache; dirty bytes that do not fit are written back immediately.
+template <class HitList>
+static void reinsert(ExtentMap& em, long long a, long long b, long long cap,
+                     const vector<Piece>& pieces, HitList hitList, int missList,
+                     bool write, ExtentStats& st)
+{
+    long long lo = max(a, b - cap);
+    auto put = [&](long long s, long long e, int l, bool dirty) {
+        if (s < lo) {
+            long long cut = min(e, lo);
+            if (dirty) st.evictedDirtyBytes += cut - s;
+            s = cut;
+        }
+        em.insertFront(s, e, l, dirty);
+    };
+
+    long long cur = a;
+    for (size_t i = 0; i < pieces.size(); i++) {
+        const Piece& pc = pieces[i];
+        if (pc.start > cur) put(cur, pc.start, missList, write);
+        put(pc.start, pc.end, hitList(pc), pc.dirty || write);
+        cur = pc.end;
+    }
+    if (cur < b) put(cur, b, missList, write);
+}
+
+/* ================== LRU ================== */
+
+struct ExtentLRUCache::Impl
+{
+    long long c = 0;
+    ExtentMap em;
+    ExtentStats st;
+    vector<Piece> pieces;
+
+    Impl() : em(1) {}
+
+    void access(long long a, long long len, const string& rw)
+    {
+        st.calls++;
+        st.bytes += len;
+        if (len <= 0 || c <= 0) return;
+
+        long long b = a + len;
+        bool write = isWriteOp(rw);
+
+        em.carve(a, b, pieces);
+        long long hit = 0;
+        for (size_t i = 0; i < pieces.size(); i++) hit += pieces[i].end - pieces[i].start;
+        st.hitBytes += hit;
+        if (write) st.writeHitBytes += hit;
+        else st.readHitBytes += hit;
+
+        long long incoming = min(len, c);
+        while (em.size(0) + incoming > c) {
+            Piece v;
+            if (!em.popBack(0, v)) break;
+            if (v.dirty) st.evictedDirtyBytes += v.end - v.start;
+        }
+
+        reinsert(em, a, b, c, pieces, [](const Piece&) { return 0; }, 0, write, st);
+        st.maxExtents = max(st.maxExtents, em.extents());
+    }
+};
+
+ExtentLRUCache::ExtentLRUCache(long long capacityBytes)
+{
+    p = new Impl();
+    p->c = max(0LL, capacityBytes);
+}
+
+ExtentLRUCache::~ExtentLRUCache()
+{
+    delete p;
+}
+
+void ExtentLRUCache::refer(long long int offset, long long int size, string rw)
+{
+    p->access(offset, size, rw);
+}
+
+void ExtentLRUCache::cacheHitsSummary()
+{
+    p->st.print(cout, "ExtentLRU", p->c, p->em.extents());
+    cout << endl;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    if (result.is_open()) {
+        p->st.print(result, "ExtentLRU", p->c, p->em.extents());
+        result << endl;
+    }
+}
+
+/* ================== ARC ================== */
+
+// ARC with every list size measured in bytes: T1/T2 hold resident extents,
+// B1/B2 hold ghost extents, and p is the byte target for T1.
+struct ExtentARCCache::Impl
+{
+    enum { T1 = 0, T2 = 1, B1 = 2, B2 = 3 };
+
+    long long c = 0;
+    long long p = 0;
+    ExtentMap em;
+    ExtentStats st;
+    vector<Piece> pieces;
+
+    Impl() : em(4) {}
+
+    long long resident() const { return em.size(T1) + em.size(T2); }
+
+    // Move the LRU extent of T1 or T2 to the MRU end of its ghost list.
+    bool REPLACE(bool hitInB2)
+    {
+        Piece v;
+        bool fromT1 = !em.empty(T1) &&
+                      (em.size(T1) > p || (hitInB2 && em.size(T1) >= p) || em.empty(T2));
+        if (fromT1) {
+            em.popBack(T1, v);
+        } else if (!em.popBack(T2, v)) {
+            return false;
+        }
+        if (v.dirty) st.evictedDirtyBytes += v.end - v.start;
+        em.insertFront(v.start, v.end, fromT1 ? B1 : B2, false);
+        return true;
+    }
+
+    // Keep |T1| + |B1| <= c and the whole directory <= 2c, in bytes.
+    void trimGhosts()
+    {
+        Piece g;
+        while (em.size(T1) + em.size(B1) > c) {
+            if (!em.popBack(B1, g)) break;
+        }
+        while (resident() + em.size(B1) + em.size(B2) > 2 * c) {
+            if (!em.popBack(B2, g) && !em.popBack(B1, g)) break;
+        }
+    }
+
+    void access(long long a, long long len, const string& rw)
+    {
+        st.calls++;
+        st.bytes += len;
+        if (len <= 0 || c <= 0) return;
+
+        long long b = a + len;
+        bool write = isWriteOp(rw);
+        long long b1Before = em.size(B1);
+        long long b2Before = em.size(B2);
+
+        em.carve(a, b, pieces);
+        long long hit = 0, g1 = 0, g2 = 0;
+        for (size_t i = 0; i < pieces.size(); i++) {
+            long long n = pieces[i].end - pieces[i].start;
+            if (pieces[i].which == B1) g1 += n;
+            else if (pieces[i].which == B2) g2 += n;
+            else hit += n;
+        }
+        st.hitBytes += hit;
+        if (write) st.writeHitBytes += hit;
+        else st.readHitBytes += hit;
+
+        // Ghost hits adapt p in proportion to the bytes that came back
+        if (g1 > 0) {
+            long long ratio = max(1LL, b2Before / max(b1Before, 1LL));
+            p = min(c, p + g1 * ratio);
+        }
+        if (g2 > 0) {
+            long long ratio = max(1LL, b1Before / max(b2Before, 1LL));
+            p = max(0LL, p - g2 * ratio);
+        }
+
+        long long incoming = min(len, c);
+        while (resident() + incoming > c) {
+            if (!REPLACE(g2 > 0)) break;
+        }
+
+        // Anything seen before (resident or ghost) is frequent -> T2, new bytes -> T1
+        reinsert(em, a, b, c, pieces, [](const Piece&) { return (int)T2; }, T1, write, st);
+        trimGhosts();
+        st.maxExtents = max(st.maxExtents, em.extents());
+    }
+};
+
+ExtentARCCache::ExtentARCCache(long long capacityBytes)
+{
+    p = new Impl();
+    p->c = max(0LL, capacityBytes);
+    p->p = 0;
+}
+
+ExtentARCCache::~ExtentARCCache()
+{
+    delete p;
+}
+
+void ExtentARCCache::refer(long long int offset, long long int size, string rw)
+{
+    p->access(offset, size, rw);
+}
+
+void ExtentARCCache::cacheHitsSummary()
+{
+    p->st.print(cout, "ExtentARC", p->c, p->em.extents());
+    cout << " p " << p->p << endl;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    if (result.is_open()) {
+        p->st.print(result, "ExtentARC", p->c, p->em.extents());
+        result << " p " << p->p << endl;
+    }
+}
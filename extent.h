@@ -0,0 +1,45 @@
+#ifndef _extent_H
+#define _extent_H
+
+#include <string>
+using namespace std;
+
+/*
+   Extent-based caches: entries are byte ranges [offset, offset + size)
+   instead of 4 KB pages. A request is served with one interval lookup;
+   cached extents are split where a request partially overlaps them and
+   merged again when neighbouring pieces end up side by side at the MRU
+   end of the same list. Capacity and hits are counted in bytes.
+*/
+
+class ExtentLRUCache
+{
+public:
+    ExtentLRUCache(long long capacityBytes);
+    ~ExtentLRUCache();
+
+    void refer(long long int offset, long long int size, string rw);
+
+    void cacheHitsSummary();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+class ExtentARCCache
+{
+public:
+    ExtentARCCache(long long capacityBytes);
+    ~ExtentARCCache();
+
+    void refer(long long int offset, long long int size, string rw);
+
+    void cacheHitsSummary();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include "ghost.h"
+#include "hash.h"
+
+#include <algorithm>
+
+using namespace std;
+
+const int GhostList::GENERATIONS;
+const uint16_t GhostList::EMPTY;
+const uint16_t GhostList::TOMB;
+
+GhostList::GhostList()
+    : compact(false), count(0), peakCount(0), cur(0), genCap(0), mask(0)
+{
+}
+
+void GhostList::init(int capacity, bool compactMode)
+{
+    compact = compactMode;
+    count = 0;
+    peakCount = 0;
+    L.clear();
+    pos.clear();
+    gens.clear();
+
+    if (!compact) {
+        pos.reserve((size_t)(max(capacity, 0) * 1.3) + 16);
+        return;
+    }
+
+    // GENERATIONS tables together hold a little more than capacity keys;
+    // each table stays at most half full so probes stay short
+    genCap = max(1, (capacity + GENERATIONS - 1) / GENERATIONS + 1);
+    size_t tableSize = 4;
+    while (tableSize < (size_t)genCap * 2) tableSize <<= 1;
+    mask = tableSize - 1;
+    gens.resize(GENERATIONS);
+    for (int i = 0; i < GENERATIONS; i++) {
+        gens[i].slots.assign(tableSize, EMPTY);
+        gens[i].count = 0;
+        gens[i].used = 0;
+        gens[i].cursor = 0;
+    }
+    cur = 0;
+}
+
+void GhostList::hashKey(long long key, uint16_t& fp, uint64_t& home)
+{
+    uint64_t h = mix64((uint64_t)key);
+    fp = (uint16_t)(h >> 48);
+    if (fp <= TOMB) fp += 2;
+    home = h;
+}
+
+bool GhostList::findIn(const Generation& g, uint16_t fp, uint64_t home, size_t& at) const
+{
+    if (g.count == 0) return false;
+    for (size_t i = home & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+        if (g.slots[i] == EMPTY) return false;
+        if (g.slots[i] == fp) {
+            at = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GhostList::contains(long long key) const
+{
+    if (!compact) return pos.find(key) != pos.end();
+
+    uint16_t fp;
+    uint64_t home;
+    size_t at;
+    hashKey(key, fp, home);
+    for (int i = 0; i < GENERATIONS; i++) {
+        if (findIn(gens[i], fp, home, at)) return true;
+    }
+    return false;
+}
+
+// Start a fresh generation; whatever is left in the oldest one is forgotten.
+void GhostList::rotate()
+{
+    cur = (cur + 1) % GENERATIONS;
+    Generation& g = gens[cur];
+    count -= g.count;
+    fill(g.slots.begin(), g.slots.end(), EMPTY);
+    g.count = 0;
+    g.used = 0;
+    g.cursor = 0;
+}
+
+void GhostList::pushFront(long long key)
+{
+    if (!compact) {
+        L.push_front(key);
+        pos[key] = L.begin();
+    } else {
+        // tombstones fill the table as much as live keys do: rotating
+        // on them keeps half the slots EMPTY, so misses stop early
+        if (gens[cur].used >= genCap) rotate();
+        uint16_t fp;
+        uint64_t home;
+        hashKey(key, fp, home);
+        Generation& g = gens[cur];
+        size_t i = home & mask;
+        while (g.slots[i] > TOMB) i = (i + 1) & mask;
+        if (g.slots[i] == EMPTY) g.used++;
+        g.slots[i] = fp;
+        g.count++;
+    }
+    count++;
+    peakCount = max(peakCount, count);
+}
+
+bool GhostList::erase(long long key)
+{
+    if (!compact) {
+        auto it = pos.find(key);
+        if (it == pos.end()) return false;
+        L.erase(it->second);
+        pos.erase(it);
+        count--;
+        return true;
+    }
+
+    uint16_t fp;
+    uint64_t home;
+    size_t at;
+    hashKey(key, fp, home);
+    // newest generation first, the matching entry is most likely there
+    for (int n = 0; n < GENERATIONS; n++) {
+        Generation& g = gens[(cur - n + GENERATIONS) % GENERATIONS];
+        if (findIn(g, fp, home, at)) {
+            g.slots[at] = TOMB;
+            g.count--;
+            count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void GhostList::popBack()
+{
+    if (count == 0) return;
+    if (!compact) {
+        pos.erase(L.back());
+        L.pop_back();
+        count--;
+        return;
+    }
+
+    // any entry of the oldest non-empty generation; the cursor sweeps the
+    // table round-robin, so this is amortized O(1)
+    for (int n = 1; n <= GENERATIONS; n++) {
+        Generation& g = gens[(cur + n) % GENERATIONS];
+        if (g.count == 0) continue;
+        while (g.slots[g.cursor] <= TOMB) g.cursor = (g.cursor + 1) & mask;
+        g.slots[g.cursor] = TOMB;
+        g.count--;
+        count--;
+        return;
+    }
+}
+
+size_t GhostList::bytes() const
+{
+    if (!compact) return (size_t)count * exactBytesPerEntry();
+    return gens.size() * (mask + 1) * sizeof(uint16_t);
+}
@@ -0,0 +1,70 @@
+#ifndef _ghost_H
+#define _ghost_H
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+using namespace std;
+
+/*
+   Ghost (history) list of recently evicted keys, MRU at front.
+
+   Exact mode is the classic std::list + unordered_map pair, ~72 bytes per
+   entry. Compact mode keeps 16-bit fingerprints in a few rotating
+   generation tables instead: membership is approximate (rare false
+   positives), recency is only kept at generation granularity and popBack()
+   drops an arbitrary entry of the oldest generation, but an entry costs
+   about 4 bytes.
+*/
+class GhostList
+{
+public:
+    GhostList();
+
+    void init(int capacity, bool compact);
+
+    bool contains(long long key) const;
+    void pushFront(long long key);
+    bool erase(long long key);   // false if key was not present
+    void popBack();
+
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int peak() const { return peakCount; }
+
+    // memory used now, and what the exact representation costs per entry
+    size_t bytes() const;
+    static size_t exactBytesPerEntry() { return 72; }
+
+private:
+    static const int GENERATIONS = 4;
+    static const uint16_t EMPTY = 0;
+    static const uint16_t TOMB = 1;
+
+    bool compact;
+    int count;
+    int peakCount;
+
+    // exact mode
+    list<long long> L;
+    unordered_map<long long, list<long long>::iterator> pos;
+
+    // compact mode: open addressing tables of fingerprints, one per generation
+    struct Generation {
+        vector<uint16_t> slots;
+        int count;
+        int used;        // slots that are not EMPTY, tombstones included
+        size_t cursor;   // popBack scan position
+    };
+    vector<Generation> gens;
+    int cur;
+    int genCap;
+    uint64_t mask;
+
+    static void hashKey(long long key, uint16_t& fp, uint64_t& home);
+    bool findIn(const Generation& g, uint16_t fp, uint64_t home, size_t& at) const;
+    void rotate();
+};
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef _hash_H
+#define _hash_H
+
+#include <stdint.h>
+
+// splitmix64 finalizer: cheap, well-mixed 64-bit hash of a page key
+static inline uint64_t mix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "heatmap.h"
+
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <stdint.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static const size_t MAX_REGIONS = 1 << 20;   // higher offsets share the last region
+static const int TOP_REGIONS = 8;
+static const double TICKS_PER_SECOND = 1e7;  // MSR timestamps are 100ns units
+
+struct RegionHeatmap::Impl
+{
+    string trace, policy;
+    int csize = 0;
+    int shift = 12;
+    long long windowTicks = 0;
+
+    struct Counters {
+        long long calls, hits, readHits, writeHits, dirtyEvictions;
+    };
+    vector<Counters> window;    // this window, indexed by region
+    vector<Counters> total;     // whole run, updated at window ends
+    size_t used = 0;            // regions touched so far
+
+    long long windowStart = -1; // trace time the window began, -1 before the first request
+    long long windows = 0;
+
+    Counters& at(long long addr) {
+        size_t r = (size_t)((uint64_t)addr >> shift);
+        if (r >= used) {
+            if (r >= MAX_REGIONS) r = MAX_REGIONS - 1;
+            if (r >= window.size()) {
+                size_t n = max(window.size() * 2, r + 1);
+                n = min(n, MAX_REGIONS);
+                Counters zero = { 0, 0, 0, 0, 0 };
+                window.resize(n, zero);
+                total.resize(n, zero);
+            }
+            used = max(used, r + 1);
+        }
+        return window[r];
+    }
+
+    void flush() {
+        struct stat st;
+        bool fresh = stat("Heatmap.csv", &st) != 0 || st.st_size == 0;
+        ofstream out("Heatmap.csv", ios_base::app);
+        if (fresh) {
+            out << "trace,policy,cacheSize,regionBytes,window,windowStartSeconds,region,regionOffset,"
+                   "calls,hits,readHits,writeHits,dirtyEvictions\n";
+        }
+        double startSeconds = windowTicks > 0 && windowStart >= 0
+            ? (double)(windows * windowTicks) / TICKS_PER_SECOND : 0.0;
+        for (size_t r = 0; r < used; r++) {
+            Counters& c = window[r];
+            if (c.calls == 0 && c.dirtyEvictions == 0) continue;
+            out << trace << "," << policy << "," << csize << "," << (1LL << shift) << ","
+                << windows << "," << startSeconds << "," << r << "," << ((long long)r << shift) << ","
+                << c.calls << "," << c.hits << "," << c.readHits << "," << c.writeHits << ","
+                << c.dirtyEvictions << "\n";
+            Counters& t = total[r];
+            t.calls += c.calls;
+            t.hits += c.hits;
+            t.readHits += c.readHits;
+            t.writeHits += c.writeHits;
+            t.dirtyEvictions += c.dirtyEvictions;
+            c.calls = c.hits = c.readHits = c.writeHits = c.dirtyEvictions = 0;
+        }
+        windows++;
+    }
+};
+
+RegionHeatmap::RegionHeatmap(const string& trace, const string& policy, int csize,
+                             long long regionBytes, double windowSeconds)
+{
+    p = new Impl();
+    p->trace = trace;
+    p->policy = policy;
+    p->csize = csize;
+    while (p->shift < 62 && (1LL << p->shift) < regionBytes) p->shift++;
+    p->windowTicks = (long long)(windowSeconds * TICKS_PER_SECOND);
+}
+
+RegionHeatmap::~RegionHeatmap()
+{
+    delete p;
+}
+
+void RegionHeatmap::onRequest(long long int timestamp)
+{
+    if (timestamp < 0 || p->windowTicks <= 0) return;
+    if (p->windowStart < 0) p->windowStart = timestamp;
+    // windows are aligned to the first request; quiet windows are skipped
+    // but keep their number
+    long long w = (timestamp - p->windowStart) / p->windowTicks;
+    if (w > p->windows) {
+        p->flush();
+        p->windows = w;
+    }
+}
+
+void RegionHeatmap::onEvict(long long int addr, bool dirty)
+{
+    if (dirty) p->at(addr).dirtyEvictions++;
+}
+
+void RegionHeatmap::onAccess(long long int addr, bool write, bool hit)
+{
+    Impl::Counters& c = p->at(addr);
+    c.calls++;
+    if (hit) {
+        c.hits++;
+        if (write) c.writeHits++; else c.readHits++;
+    }
+}
+
+void RegionHeatmap::finish()
+{
+    p->flush();
+}
+
+void RegionHeatmap::report()
+{
+    vector<size_t> order;
+    long long hits = 0;
+    for (size_t r = 0; r < p->used; r++) {
+        hits += p->total[r].hits;
+        if (p->total[r].calls > 0) order.push_back(r);
+    }
+    size_t touched = order.size();
+    sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return p->total[a].hits > p->total[b].hits;
+    });
+    if (order.size() > (size_t)TOP_REGIONS) order.resize(TOP_REGIONS);
+    long long topHits = 0;
+    for (size_t i = 0; i < order.size(); i++) topHits += p->total[order[i]].hits;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "Heatmap " << p->policy
+            << " CacheSize " << p->csize
+            << " regionBytes " << (1LL << p->shift)
+            << " windows " << p->windows
+            << " regions " << touched
+            << " topShareOfHits " << (hits ? (double)topHits / hits : 0.0)
+            << " top";
+        // region:hits:hitRatio, hottest first
+        for (size_t i = 0; i < order.size(); i++) {
+            const Impl::Counters& t = p->total[order[i]];
+            out << " " << order[i] << ":" << t.hits << ":" << (double)t.hits / t.calls;
+        }
+        out << endl;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef _heatmap_H
+#define _heatmap_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   Per-region counters over the offset space: calls, hits, read and write
+   hits and dirty evictions. A region is a power-of-two range of offsets,
+   so the counter of a page is found by shifting its key; the table grows
+   as higher regions show up. Counters are written out and cleared every
+   window of trace time (MSR timestamps); traces without timestamps make a
+   single window. Rows go to Heatmap.csv, one per non-empty region and
+   window, i.e. a sparse region x window matrix per policy and size.
+*/
+class RegionHeatmap : public CacheObserver
+{
+public:
+    // regionBytes is rounded up to a power of two of at least 4KB
+    RegionHeatmap(const string& trace, const string& policy, int csize,
+                  long long regionBytes, double windowSeconds);
+    ~RegionHeatmap();
+
+    void onEvict(long long int addr, bool dirty);
+    void onAccess(long long int addr, bool write, bool hit);
+    void onRequest(long long int timestamp);
+
+    // write out the last window
+    void finish();
+
+    // the hottest regions of the whole run
+    void report();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
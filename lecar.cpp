@@ -0,0 +1,252 @@
+#include "lecar.h"
+
+#include <list>
+#include <unordered_map>
+#include <random>
+#include <cmath>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+// Bounded FIFO of evicted pages with the time they were evicted
+class EvictionHistory
+{
+public:
+    void init(int cap) { capacity = cap; pos.reserve(cap + 1); }
+
+    // time of the eviction, or -1; the entry is removed
+    long long take(long long key)
+    {
+        auto it = pos.find(key);
+        if (it == pos.end()) return -1;
+        long long t = it->second->second;
+        L.erase(it->second);
+        pos.erase(it);
+        return t;
+    }
+
+    void add(long long key, long long time)
+    {
+        if (capacity <= 0) return;
+        if ((int)pos.size() >= capacity) {
+            pos.erase(L.back().first);
+            L.pop_back();
+        }
+        L.push_front(make_pair(key, time));
+        pos[key] = L.begin();
+    }
+
+private:
+    int capacity = 0;
+    list<pair<long long, long long> > L;    // newest at front
+    unordered_map<long long, list<pair<long long, long long> >::iterator> pos;
+};
+
+struct LeCaRCache::Impl
+{
+    LeCaRCache* owner = nullptr;
+
+    int c = 0;
+    double learningRate = 0.45;
+    double discount = 1.0;
+    double wLRU = 0.5;
+    double wLFU = 0.5;
+    long long time = 0;
+    mt19937 rng;
+
+    long long calls = 0;
+    long long hits = 0;
+    long long readHits = 0;
+    long long writeHits = 0;
+    long long evictedDirtyPage = 0;
+    long long lruEvictions = 0;
+    long long lfuEvictions = 0;
+
+    // LRU expert: MRU at front
+    list<long long> lruList;
+
+    // LFU expert: freq -> pages, MRU at front, so ties go to the LRU page
+    unordered_map<int, list<long long> > freqBuckets;
+    int minFreq = 1;
+
+    struct Page {
+        int freq;
+        bool dirty;
+        list<long long>::iterator lruIter;
+        list<long long>::iterator freqIter;
+    };
+    unordered_map<long long, Page> table;
+
+    EvictionHistory lruHistory, lfuHistory;
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    void addToBucket(long long k, Page& pg) {
+        list<long long>& b = freqBuckets[pg.freq];
+        b.push_front(k);
+        pg.freqIter = b.begin();
+    }
+
+    void removeFromBucket(Page& pg) {
+        auto b = freqBuckets.find(pg.freq);
+        b->second.erase(pg.freqIter);
+        if (b->second.empty()) {
+            freqBuckets.erase(b);
+            if (minFreq == pg.freq) minFreq++;
+        }
+    }
+
+    long long lfuVictim() {
+        if (table.empty()) return -1;
+        // minFreq only drifts upwards past emptied buckets
+        while (freqBuckets.find(minFreq) == freqBuckets.end()) minFreq++;
+        return freqBuckets[minFreq].back();
+    }
+
+    // Regret: the page came back after `expert` evicted it, so the other
+    // expert gains weight, less so the longer ago the eviction was
+    void regret(double& winner, long long evictedAt) {
+        double r = pow(discount, (double)(time - evictedAt));
+        winner *= exp(learningRate * r);
+        double sum = wLRU + wLFU;
+        wLRU /= sum;
+        wLFU /= sum;
+    }
+
+    void evict() {
+        long long lru = lruList.back();
+        long long lfu = lfuVictim();
+        uniform_real_distribution<double> coin(0.0, 1.0);
+        bool useLRU = coin(rng) < wLRU;
+        long long v = useLRU ? lru : lfu;
+
+        auto it = table.find(v);
+        Page& pg = it->second;
+        if (pg.dirty) evictedDirtyPage++;
+        owner->notifyEvict(v, pg.dirty, useLRU ? SEG_LRU : SEG_LFU);
+        lruList.erase(pg.lruIter);
+        removeFromBucket(pg);
+        table.erase(it);
+
+        // when both experts agree neither one is to blame later
+        if (lru != lfu) {
+            if (useLRU) lruHistory.add(v, time);
+            else lfuHistory.add(v, time);
+        }
+        if (useLRU) lruEvictions++; else lfuEvictions++;
+    }
+
+    bool access(long long k, const string& rw) {
+        calls++;
+        time++;
+        bool write = isWrite(rw);
+
+        auto it = table.find(k);
+        if (it != table.end()) {
+            hits++;
+            if (write) writeHits++; else readHits++;
+            Page& pg = it->second;
+            lruList.erase(pg.lruIter);
+            lruList.push_front(k);
+            pg.lruIter = lruList.begin();
+            removeFromBucket(pg);
+            pg.freq++;
+            addToBucket(k, pg);
+            if (write) pg.dirty = true;
+            return true;
+        }
+
+        if (c <= 0) return false;
+
+        long long t;
+        if ((t = lruHistory.take(k)) >= 0) regret(wLFU, t);
+        else if ((t = lfuHistory.take(k)) >= 0) regret(wLRU, t);
+
+        if ((int)table.size() >= c) evict();
+
+        Page pg;
+        pg.freq = 1;
+        pg.dirty = write;
+        lruList.push_front(k);
+        pg.lruIter = lruList.begin();
+        addToBucket(k, pg);
+        minFreq = 1;
+        table[k] = pg;
+        return false;
+    }
+};
+
+LeCaRCache::LeCaRCache(int size, unsigned seed)
+{
+    p = new Impl();
+    p->owner = this;
+    p->c = max(0, size);
+    // a regret fades to 0.005 after one cache's worth of accesses
+    p->discount = pow(0.005, 1.0 / max(1, p->c));
+    p->rng.seed(seed);
+    p->lruHistory.init(p->c);
+    p->lfuHistory.init(p->c);
+    p->table.reserve(p->c + 1);
+}
+
+LeCaRCache::~LeCaRCache()
+{
+    delete p;
+}
+
+void LeCaRCache::refer(long long int addr, string rw)
+{
+    bool hit = p->access(addr, rw);
+    notifyAccess(addr, Impl::isWrite(rw), hit);
+}
+
+bool LeCaRCache::contains(long long int addr)
+{
+    return p->table.find(addr) != p->table.end();
+}
+
+long long int LeCaRCache::victim()
+{
+    // the draw is random; report the victim of the favoured expert
+    if ((int)p->table.size() < p->c || p->table.empty()) return -1;
+    return p->wLRU >= p->wLFU ? p->lruList.back() : p->lfuVictim();
+}
+
+bool LeCaRCache::remove(long long int addr, bool& dirty)
+{
+    // neither expert evicted it, so no history entry
+    auto it = p->table.find(addr);
+    if (it == p->table.end()) return false;
+    dirty = it->second.dirty;
+    p->lruList.erase(it->second.lruIter);
+    p->removeFromBucket(it->second);
+    p->table.erase(it);
+    return true;
+}
+
+void LeCaRCache::cacheHitsSummary()
+{
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "LeCaR CacheSize " << p->c
+            << " calls " << p->calls
+            << " hits " << p->hits
+            << " hitRatio " << (p->calls ? (double)p->hits / p->calls : 0.0)
+            << " readHits " << p->readHits
+            << " readHitRatio " << (p->calls ? (double)p->readHits / p->calls : 0.0)
+            << " writeHits " << p->writeHits
+            << " writeHitRatio " << (p->calls ? (double)p->writeHits / p->calls : 0.0)
+            << " evictedDirtyPage " << p->evictedDirtyPage
+            << " lruEvictions " << p->lruEvictions
+            << " lfuEvictions " << p->lfuEvictions
+            << " wLRU " << p->wLRU
+            << endl;
+    }
+}
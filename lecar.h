@@ -0,0 +1,36 @@
+#ifndef _lecar_H
+#define _lecar_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   LeCaR (Vietri et al.): an LRU and an LFU expert, each with a history of
+   the pages it evicted. A miss on a page in one expert's history is
+   regret for that expert and shifts weight to the other one, discounted
+   by how long ago the eviction was. The evicting expert is drawn at
+   random according to the weights, from a seeded generator so runs are
+   reproducible.
+*/
+class LeCaRCache : public CachePolicy
+{
+public:
+    LeCaRCache(int, unsigned seed = 42);
+    ~LeCaRCache();
+
+    void refer(long long int addr, string rw);
+
+    void cacheHitsSummary();
+    void report() { cacheHitsSummary(); }
+    bool contains(long long int addr);
+    long long int victim();
+    bool remove(long long int addr, bool& dirty);
+    bool canRemove() const { return true; }
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -38,33 +38,13 @@ LFUCache::~LFUCache() {
 void LFUCache::refer(long long int key, string rwtype) {
     calls++;
 
+    bool hit = key_to_freq.find(key) != key_to_freq.end();
+
     // If key is not present in cache
-    if (key_to_freq.find(key) == key_to_freq.end()) {
+    if (!hit) {
         // If cache is full -> evict one key from the smallest frequency bucket
         if ((int)key_to_freq.size() == capacity) {
-            if (!key_freq_list.empty()) {
-                // find smallest frequency
-                int min_freq = INT_MAX;
-                for (const auto &p : key_freq_list) {
-                    if (p.first < min_freq) min_freq = p.first;
-                }
-                auto &freq_list = key_freq_list[min_freq];
-                // evict the oldest key in that frequency bucket (front)
-                long long int lfu_key = freq_list.front();
-                // remove from freq list and bookkeeping
-                freq_list.pop_front();
-                if (freq_list.empty()) {
-                    key_freq_list.erase(min_freq);
-                }
-                // erase key metadata
-                key_to_freq.erase(lfu_key);
-                auto itit = key_iter.find(lfu_key);
-                if (itit != key_iter.end()) key_iter.erase(itit);
-                if (accessType[lfu_key] == "Write") {
-                    evictedDirtyPage++;
-                }
-                accessType.erase(lfu_key);
-            }
+            evictOne();
         }
 
         // Insert the new key into frequency 1 bucket
@@ -100,6 +80,67 @@ void LFUCache::refer(long long int key, string rwtype) {
             accessType[key] = "Write";
         }
     }
+
+    notifyAccess(key, rwtype == "Write", hit);
+}
+
+void LFUCache::evictOne() {
+    if (key_freq_list.empty()) return;
+    // find smallest frequency
+    int min_freq = INT_MAX;
+    for (const auto &p : key_freq_list) {
+        if (p.first < min_freq) min_freq = p.first;
+    }
+    auto &freq_list = key_freq_list[min_freq];
+    // evict the oldest key in that frequency bucket (front)
+    long long int lfu_key = freq_list.front();
+    // remove from freq list and bookkeeping
+    freq_list.pop_front();
+    if (freq_list.empty()) {
+        key_freq_list.erase(min_freq);
+    }
+    // erase key metadata
+    key_to_freq.erase(lfu_key);
+    auto itit = key_iter.find(lfu_key);
+    if (itit != key_iter.end()) key_iter.erase(itit);
+    if (accessType[lfu_key] == "Write") {
+        evictedDirtyPage++;
+    }
+    notifyEvict(lfu_key, accessType[lfu_key] == "Write");
+    accessType.erase(lfu_key);
+}
+
+void LFUCache::resize(int newSize) {
+    capacity = newSize < 0 ? 0 : newSize;
+    while ((int)key_to_freq.size() > capacity && !key_freq_list.empty()) {
+        evictOne();
+    }
+}
+
+long long int LFUCache::victim() {
+    if ((int)key_to_freq.size() < capacity || key_freq_list.empty()) return -1;
+    // same choice refer() makes: oldest key of the smallest frequency bucket
+    int min_freq = INT_MAX;
+    for (const auto &p : key_freq_list) {
+        if (p.first < min_freq) min_freq = p.first;
+    }
+    return key_freq_list[min_freq].front();
+}
+
+bool LFUCache::remove(long long int key, bool& dirty) {
+    auto f = key_to_freq.find(key);
+    if (f == key_to_freq.end()) return false;
+    int freq = f->second;
+    auto &freq_list = key_freq_list[freq];
+    freq_list.erase(key_iter[key]);
+    if (freq_list.empty()) {
+        key_freq_list.erase(freq);
+    }
+    key_to_freq.erase(f);
+    key_iter.erase(key);
+    dirty = accessType[key] == "Write";
+    accessType.erase(key);
+    return true;
 }
 
 void LFUCache::cacheHits() {
@@ -4,17 +4,19 @@
    is to discard, in each step, the item with the smallest frequency of usage. The LFU algorithm
    counts how often an item is needed. Those that are used least often are discarded first.
 */
+#include <climits>
 #include <ctime>
 #include <fstream>
 #include <iostream>
 #include <list>
 #include <string.h>
 #include <unordered_map>
+#include "policy.h"
 using namespace std;
 #ifndef _lfu_H
 #define _lfu_H
 
-class LFUCache
+class LFUCache : public CachePolicy
 {
     // store keys of cache
     std::list<long long int> key_list;
@@ -49,6 +51,16 @@ class LFUCache
 
     void refer(long long int, string);
     void cacheHits();
+    void report() { cacheHits(); }
+    bool contains(long long int key) { return key_to_freq.find(key) != key_to_freq.end(); }
+    long long int victim();
+    bool remove(long long int key, bool& dirty);
+    bool canRemove() const { return true; }
+    void resize(int newSize);
+    bool canResize() const { return true; }
+
+    private:
+    void evictOne();
 };
 
 #endif
\ No newline at end of file
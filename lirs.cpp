@@ -3,16 +3,23 @@
 #include <unordered_map>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cmath>
 #include <algorithm>
+#include "ghost.h"
 
 using namespace std;
 
 struct LIRSCache::Impl {
 
+    LIRSCache* owner = nullptr;
+
     int csize;
     int hirCap;
     int lirTarget;
+    double hirShare;
+    double historyBound;
+    int historyCap = 0;     // exact non-resident entries, 0 for no bound
 
     long long calls = 0;
     long long hits = 0;
@@ -31,15 +38,28 @@ struct LIRSCache::Impl {
     list<long long> L;
     unordered_map<long long, list<long long>::iterator> Lpos;
 
+    // Non-resident pages still in S, most recently evicted first; only
+    // kept while the history is bounded
+    list<long long> NR;
+
     struct PageInfo {
         bool isLIR = false;
         bool resident = false;
         bool dirty = false;
+        bool inNR = false;
+        list<long long>::iterator nrPos;
     };
     unordered_map<long long, PageInfo> page;
 
+    // non-resident pages pushed out of S by the bound, as fingerprints
+    GhostList history;
+    long long historyHits = 0;      // misses promoted through a fingerprint
+    size_t peakEntries = 0;         // largest page table
+
     int residentCount = 0;
     int lirCount = 0;
+    long long hirPromotions = 0;     // hits on resident HIR pages
+    long long nonResidentHits = 0;   // misses on pages still in S
 
     static bool isWrite(const string& rw) {
         return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
@@ -82,6 +102,7 @@ struct LIRSCache::Impl {
             long long b = S.back();
             auto pit = page.find(b);
             if (pit == page.end() || (!pit->second.isLIR && !pit->second.resident)) {
+                if (pit != page.end() && pit->second.inNR) NR.erase(pit->second.nrPos);
                 Spos.erase(b);
                 S.pop_back();
                 Lpos.erase(b);
@@ -103,6 +124,44 @@ struct LIRSCache::Impl {
         pushFrontQ(victim);
     }
 
+    void leaveNR(PageInfo& info) {
+        if (!info.inNR) return;
+        NR.erase(info.nrPos);
+        info.inNR = false;
+    }
+
+    // The oldest non-resident entries beyond the bound leave S and the
+    // page table; a fingerprint remembers they were recently in S
+    void trimHistory() {
+        while ((int)NR.size() > historyCap) {
+            long long k = NR.back();
+            NR.pop_back();
+            auto sit = Spos.find(k);
+            S.erase(sit->second);
+            Spos.erase(sit);
+            page.erase(k);
+            history.pushFront(k);
+        }
+    }
+
+    void setSize(int size) {
+        csize = size;
+        if (historyBound > 0) {
+            int cap = max(1, (int)(historyBound * size));
+            // a new bound starts an empty fingerprint table
+            if (cap != historyCap) history.init(cap, true);
+            historyCap = cap;
+        }
+        if (size <= 1) {
+            hirCap = 1;
+            lirTarget = 0;
+        } else {
+            hirCap = max(1, (int)ceil(size * hirShare));
+            hirCap = min(hirCap, size - 1);
+            lirTarget = size - hirCap;
+        }
+    }
+
     void evictHIR() {
         if (Q.empty()) return;
         long long victim = Q.back();
@@ -111,10 +170,21 @@ struct LIRSCache::Impl {
 
         PageInfo &info = page[victim];
         if (info.dirty) evictedDirtyPage++;
+        owner->notifyEvict(victim, info.dirty, SEG_HIR);
         info.resident = false;
         info.dirty = false;
 
         residentCount--;
+
+        // out of S as well, so nothing is left to remember
+        if (Spos.find(victim) == Spos.end()) {
+            page.erase(victim);
+        } else if (historyCap > 0) {
+            NR.push_front(victim);
+            info.inNR = true;
+            info.nrPos = NR.begin();
+            trimHistory();
+        }
     }
 
     void onHit(long long k, const string& rw) {
@@ -130,6 +200,7 @@ struct LIRSCache::Impl {
         if (info.isLIR) {
             moveToTopL(k);
         } else {
+            hirPromotions++;
             removeFromQ(k);
             info.isLIR = true;
             lirCount++;
@@ -144,6 +215,11 @@ struct LIRSCache::Impl {
 
         PageInfo &info = page[k];
         bool seenBefore = (Spos.find(k) != Spos.end());
+        leaveNR(info);
+        if (!seenBefore && historyCap > 0 && history.erase(k)) {
+            seenBefore = true;
+            historyHits++;
+        }
 
         if (residentCount >= csize) evictHIR();
 
@@ -154,6 +230,7 @@ struct LIRSCache::Impl {
         moveToTopS(k);
 
         if (seenBefore) {
+            nonResidentHits++;
             info.isLIR = true;
             lirCount++;
             moveToTopL(k);
@@ -173,18 +250,12 @@ struct LIRSCache::Impl {
 
 /* ================== PUBLIC ================== */
 
-LIRSCache::LIRSCache(int size) {
+LIRSCache::LIRSCache(int size, double hirShare, double historyBound) {
     p = new Impl();
-    p->csize = size;
-
-    if (size <= 1) {
-        p->hirCap = 1;
-        p->lirTarget = 0;
-    } else {
-        p->hirCap = max(1, (int)ceil(size * 0.01));
-        p->hirCap = min(p->hirCap, size - 1);
-        p->lirTarget = size - p->hirCap;
-    }
+    p->owner = this;
+    p->hirShare = hirShare;
+    p->historyBound = historyBound;
+    p->setSize(size);
 
     // Reserve maps for speed
     p->page.reserve(size * 2);
@@ -199,14 +270,68 @@ void LIRSCache::refer(long long int addr, string rw) {
     p->calls++;
 
     auto it = p->page.find(addr);
-    if (it != p->page.end() && it->second.resident) {
+    bool hit = it != p->page.end() && it->second.resident;
+    if (hit) {
         p->onHit(addr, rw);
     } else {
         p->onMiss(addr, rw);
     }
+    p->peakEntries = max(p->peakEntries, p->page.size());
+    notifyAccess(addr, Impl::isWrite(rw), hit);
+}
+
+bool LIRSCache::contains(long long int addr) {
+    auto it = p->page.find(addr);
+    return it != p->page.end() && it->second.resident;
+}
+
+void LIRSCache::resize(int newSize) {
+    p->setSize(max(0, newSize));
+    // extra LIR pages become HIR first, then the HIR queue gives up pages
+    while (p->lirCount > p->lirTarget && !p->L.empty()) p->demoteOneLIR();
+    while (p->residentCount > p->csize && !p->Q.empty()) p->evictHIR();
+    p->pruneS();
+    p->trimHistory();
+}
+
+long long int LIRSCache::victim() {
+    // misses evict the resident HIR page at the end of Q
+    if (p->residentCount < p->csize || p->Q.empty()) return -1;
+    return p->Q.back();
+}
+
+void LIRSCache::telemetryFields(vector<string>& names) const {
+    const char* fields[] = { "lir", "hirResident", "stackS", "nonResident", "hirPromotions", "nonResidentHits" };
+    names.assign(fields, fields + 6);
+}
+
+void LIRSCache::telemetry(vector<double>& values) const {
+    values.clear();
+    values.push_back(p->lirCount);
+    values.push_back((double)p->Q.size());
+    values.push_back((double)p->S.size());
+    values.push_back((double)(p->page.size() - p->residentCount));
+    values.push_back((double)p->hirPromotions);
+    values.push_back((double)p->nonResidentHits);
 }
 
+// page table entry plus S node and position, as for exact ghost lists
+static const size_t ENTRY_BYTES = 2 * GhostList::exactBytesPerEntry();
+
 void LIRSCache::cacheHitsResult() {
+    // the bound's costs and gains; unbounded runs keep the usual row
+    string history;
+    if (p->historyCap > 0) {
+        ostringstream h;
+        h << " historyBound " << p->historyCap
+          << " nonResident " << (p->page.size() - p->residentCount)
+          << " historyFingerprints " << p->history.size()
+          << " historyHits " << p->historyHits
+          << " peakEntries " << p->peakEntries
+          << " metadataBytes " << p->peakEntries * ENTRY_BYTES + p->history.bytes();
+        history = h.str();
+    }
+
     cout << "LIRS CacheSize " << p->csize
          << " calls " << p->calls
          << " hits " << p->hits
@@ -216,6 +341,7 @@ void LIRSCache::cacheHitsResult() {
          << " writeHits " << p->writeHits
          << " writeHitRatio " << (p->calls ? (double)p->writeHits / p->calls : 0.0)
          << " evictedDirtyPage " << p->evictedDirtyPage
+         << history
          << endl;
 
     ofstream out("ExperimentalResult.txt", ios::app);
@@ -227,6 +353,7 @@ void LIRSCache::cacheHitsResult() {
             << " readHits " << p->readHits
             << " writeHits " << p->writeHits
             << " evictedDirtyPage " << p->evictedDirtyPage
+            << history
             << "\n";
     }
 }
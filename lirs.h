@@ -2,18 +2,29 @@
 #define _lirs_H
 
 #include <string>
+#include "policy.h"
 using namespace std;
 
-class LIRSCache
+class LIRSCache : public CachePolicy
 {
 public:
-    LIRSCache(int);
+    // hirShare: part of the cache kept for resident HIR pages
+    // historyBound: non-resident entries kept exactly, in cache sizes;
+    // older ones become fingerprints. 0 leaves the history unbounded
+    LIRSCache(int, double hirShare = 0.01, double historyBound = 0);
     ~LIRSCache();
 
     void refer(long long int addr, string rw);
 
     // Match the rest of your framework
     void cacheHitsResult();
+    bool contains(long long int addr);
+    long long int victim();
+    void report() { cacheHitsResult(); }
+    void resize(int newSize);
+    bool canResize() const { return true; }
+    void telemetryFields(vector<string>& names) const;
+    void telemetry(vector<double>& values) const;
 
 private:
     // opaque in header; defined in lirs.cpp
@@ -62,20 +62,11 @@ void LRUCache::refer(long long int x, string rwtype) {
 	//total_calls++;
 	// if reference is not cached 
 	
-	if (ma.find(x) == ma.end()) {
+	bool hit = ma.find(x) != ma.end();
+	if (!hit) {
 		// if cache is full
 		if (dq.size() == csize) {
-			// evict the least used key, "last" is the key that is least used
-			long long int last = dq.back();
-			// evict the least used key from std::list<int> dp 
-			dq.pop_back();
-			// evict the least used key and its iterator from unordered_map<int, std::list<int>::iteratr> ma by key
-			ma.erase(last);
-
-			if(accessType[last] == "Write"){
-				evictedDirtyPage++;				
-			}
-			
+			evictLast();
 		}
 		// if reference is not cached, then it must be migrated into Optane cache
 		//migration++;
@@ -100,6 +91,49 @@ void LRUCache::refer(long long int x, string rwtype) {
 	dq.push_front(x);
 	ma[x] = dq.begin();
 
+	notifyAccess(x, rwtype == "Write", hit);
+}
+
+// a prefetched page goes to the front like a demand miss, but is not a call
+void LRUCache::prefetch(long long int x) {
+	if (ma.find(x) != ma.end() || csize <= 0) return;
+	if ((int)dq.size() >= csize) {
+		evictLast();
+	}
+	accessType[x] = "Read";
+	dq.push_front(x);
+	ma[x] = dq.begin();
+}
+
+void LRUCache::evictLast() {
+	// evict the least used key, "last" is the key that is least used
+	long long int last = dq.back();
+	// evict the least used key from std::list<int> dp 
+	dq.pop_back();
+	// evict the least used key and its iterator from unordered_map<int, std::list<int>::iteratr> ma by key
+	ma.erase(last);
+
+	if(accessType[last] == "Write"){
+		evictedDirtyPage++;				
+	}
+	notifyEvict(last, accessType[last] == "Write");
+}
+
+void LRUCache::resize(int n) {
+	csize = n < 0 ? 0 : n;
+	while ((int)dq.size() > csize) {
+		evictLast();
+	}
+}
+
+bool LRUCache::remove(long long int x, bool& dirty) {
+	std::unordered_map<long long int, std::list<long long int>::iterator>::iterator it = ma.find(x);
+	if (it == ma.end()) return false;
+	dq.erase(it->second);
+	ma.erase(it);
+	dirty = accessType[x] == "Write";
+	accessType.erase(x);
+	return true;
 }
 
 void LRUCache::display() {
@@ -9,11 +9,12 @@ This can be optimized by storing a reference
 (iterator) to each key in a hash map. 
 */
 #include <string.h>
+#include "policy.h"
 using namespace std; 
 #ifndef _lru_H
 #define _lru_H
 
-class LRUCache
+class LRUCache : public CachePolicy
 {
 	// store keys of cache 
 	std::list<long long int> dq;
@@ -41,14 +42,24 @@ class LRUCache
 
 	long long int migration, total_migration;
 
+	void evictLast();
+
 public:
 	LRUCache(int);
 	~LRUCache();
 	void refer(long long int, string);
+	void prefetch(long long int);
 	void display();
 
 	// summary results
 	void cachehits();
+	void report() { cachehits(); }
+	bool contains(long long int x) { return ma.find(x) != ma.end(); }
+	long long int victim() { return (int)dq.size() < csize ? -1 : dq.back(); }
+	bool remove(long long int x, bool& dirty);
+	bool canRemove() const { return true; }
+	void resize(int n);
+	bool canResize() const { return true; }
 
 	void refresh();
 	void summary();
@@ -11,25 +11,251 @@
 #include "lirs.h"
 #include "cacheus.h"
 #include "arc.h"
-//#include "mq.h"
+#include "extent.h"
+#include "policy.h"
+#include "writeback.h"
+#include "device.h"
+#include "tinylfu.h"
+#include "s3fifo.h"
+#include "sieve.h"
+#include "perfcounters.h"
+#include "analyze.h"
+#include "opt.h"
+#include "tier.h"
+#include "tune.h"
+#include "tracereader.h"
+#include "eventlog.h"
+#include "heatmap.h"
+#include "missclass.h"
+#include "telemetry.h"
+#include "partition.h"
+#include "streambypass.h"
+#include "readahead.h"
+#include "openloop.h"
+#include <thread>
+#include "mq.h"
 //#include "mru.h"
-//#include "lecar.h"
+#include "lecar.h"
 //#include "harc.h"
 //#include "exp.h"
 #include <math.h>
+#include <vector>
+#include <chrono>
 #define CACHESIZE 1 // in GB
 static const char* pgmname;
 using namespace std; 
 
+void usage();
+
+// Policies that can be driven through the common CachePolicy interface
+static CachePolicy* makePolicy(const string& name, int csize, const PolicyParams& params)
+{
+	if (name == "LRU") return new LRUCache(csize);
+	if (name == "LFU") return new LFUCache(csize);
+	if (name == "LIRS") return new LIRSCache(csize, params.lirsHirShare, params.lirsHistory);
+	if (name == "ARC") return new ARCCache(csize, params.compactGhosts, params.arcGhostFactor);
+	if (name == "CACHEUS") return new CACHEUSCache(csize, params.compactGhosts, params.cacheusHistory, params.cacheusAlpha);
+	if (name == "S3FIFO") return new S3FIFOCache(csize);
+	if (name == "SIEVE") return new SIEVECache(csize);
+	if (name == "MQ") return new MQCache(csize);
+	if (name == "LeCaR") return new LeCaRCache(csize, params.seed);
+	return NULL;
+}
+
+// Names -m accepts: the policies above and the offline modes
+static bool knownPolicy(const string& name)
+{
+	static const char* names[] = { "LRU", "LFU", "LIRS", "ARC", "CACHEUS", "S3FIFO", "SIEVE",
+		"MQ", "LeCaR", "analyze", "OPT", "dump" };
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		if (name == names[i]) return true;
+	}
+	return false;
+}
+
+// Each result row starts with the trace name, the policy appends the rest
+static void recordFilename(const char* filename)
+{
+	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+	if (result.is_open()) { 
+		result <<  filename << " ";			
+	}
+	result.close();
+}
+
+// "-s 100,1000,..." for the modes that sweep several sizes in one run
+static vector<int> parseSizes(const string& sizeArg)
+{
+	vector<int> sizes;
+	for (size_t at = 0; at != string::npos;) {
+		sizes.push_back(atoi(sizeArg.c_str() + at));
+		at = sizeArg.find(',', at);
+		if (at != string::npos) at++;
+	}
+	return sizes;
+}
+
+// Replay a trace against a policy. MSR requests are split into 4KB page
+// references; TPC-H rows are "timestamp key pattern". Request boundaries
+// are announced to the observers before the pages are referenced.
+// A shadow policy, if given, sees exactly the same page references.
+// Reading and parsing run ahead on the TraceReader's thread.
+static int replay(TraceReader& trace, int trace_type, CachePolicy& ca, CacheObserver& observers,
+	CachePolicy* shadow)
+{
+	if (!trace.ok()) {
+		std::cerr << "error: unable to open input file" << std::endl;
+		return -1;
+	}
+	TraceRecord r;
+	if (trace_type == 2) {  // for MSR traces
+		while (trace.next(r)) {
+			const string& rwtype = r.rwName();
+			observers.onRequest(r.timestamp);
+			ca.beginRequest(r.tenant, r.offset, r.size);
+
+			//request unit: 0.5KB
+			int pages = r.size > 0 ? (r.size + 4 * 1024 - 1) / (4 * 1024) : 0;
+			for (int i = 0; i < pages; i++) {
+				ca.refer(r.offset + i * 1024 * 4, rwtype);
+				if (shadow) shadow->refer(r.offset + i * 1024 * 4, rwtype);
+			}
+		}
+	}
+	else {    // for TPC-H traces
+		while (trace.next(r)) {
+			observers.onRequest(-1);
+			ca.refer(r.offset, r.rwName());
+			if (shadow) shadow->refer(r.offset, r.rwName());
+		}
+	}
+	return 0;
+}
+
+// Collects the page references of a trace so they can be replayed from
+// memory, timing the policy without the trace parsing
+class RecordingPolicy : public CachePolicy
+{
+public:
+	std::vector<long long> keys;
+	std::vector<char> writes;
+
+	void refer(long long int addr, string rw) {
+		keys.push_back(addr);
+		writes.push_back(rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+	}
+	void report() {}
+	bool contains(long long int) { return false; }
+	long long int victim() { return -1; }
+};
+
+// Replay recorded references against a policy and return the wall time
+static double timedReplay(const RecordingPolicy& refs, CachePolicy& ca)
+{
+	const string read = "Read", write = "Write";
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < refs.keys.size(); i++) {
+		ca.refer(refs.keys[i], refs.writes[i] ? write : read);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+// Replay an MSR trace against an extent cache: one refer per request
+// instead of one per 4KB page.
+template <class ExtentCache>
+static int replayExtents(ExtentCache& ca, TraceReader& trace)
+{
+	if (!trace.ok()) {
+		std::cerr << "error: unable to open input file" << std::endl;
+		return -1;
+	}
+	TraceRecord r;
+	while (trace.next(r)) {
+		ca.refer(r.offset, r.size, r.rwName());
+	}
+	ca.cacheHitsSummary();
+	std::cout << std::endl;
+	return 0;
+}
+
+// Replay an MSR trace against a partitioned cache: the pages of a request
+// go to the partition of its (device, disk)
+static int replayTenants(PartitionedCache& ca, TraceReader& trace)
+{
+	if (!trace.ok()) {
+		std::cerr << "error: unable to open input file" << std::endl;
+		return -1;
+	}
+	TraceRecord r;
+	while (trace.next(r)) {
+		const string& rwtype = r.rwName();
+		int pages = r.size > 0 ? (r.size + 4 * 1024 - 1) / (4 * 1024) : 0;
+		for (int i = 0; i < pages; i++) {
+			ca.refer(r.tenant, r.offset + i * 1024 * 4, rwtype);
+		}
+	}
+	return 0;
+}
+
 void usage()
 {
 	fprintf(stderr,
 		"Usage: %s -m <cache policy> -i <1:TCP/2:MSR> -f <filename>\n\n\
-		-m <cache policy>  LRU, MRU, LFU, MQ, ARC, LeCar, Exp ...\n\
+		-m <cache policy>  LRU, LFU, LIRS, ARC, CACHEUS, S3FIFO, SIEVE, MQ, LeCaR\n\
+		   or analyze: one-pass trace statistics in constant memory, no -s\n\
+		   or OPT: offline Belady MIN (hit-ratio upper bound) and the\n\
+		    clean-first MIN heuristic, which trades hits for dirty evictions\n\
+		   or dump: print the events of an -l log given as -i, no -f or -s\n\
 		-f <TCP or MSR> 1: TPC 2: MSR traces\n\
-		-i <filename> \n\
+		-i <filename>  or - to read the trace (or -m dump log) from stdin,\n\
+		    e.g. zstdcat trace.csv.zst | %s ... -i -\n\
 		-s <cacheSize> \n\
-		", pgmname);
+		-e  extent mode (LRU, ARC): cache byte ranges, -s is in 4KB pages\n\
+		-w <dirtyRatio>  simulate write-back flushing, e.g. 0.2\n\
+		-d <SSD|HDD>  estimate request latency on a backing device\n\
+		-q <queueDepth>  override the device queue depth\n\
+		-a TinyLFU  W-TinyLFU admission filter in front of the policy\n\
+		-g <compact|compare>  fingerprint ghost lists for ARC/CACHEUS; compare\n\
+		    also runs exact ghosts alongside and reports the hit-ratio deviation\n\
+		-t  load the trace into memory first and report the policy's refs/sec\n\
+		-r <seed>  seed for randomized policies (LeCaR), default 42\n\
+		-p  hardware counters per 1000 references around the replay loop\n\
+		-T <upperPages>[,inclusive|exclusive[,promoteAfter]]  two-tier\n\
+		    hierarchy (DRAM over PMEM/NVMe), -s is the lower tier; misses are\n\
+		    served from -d (default SSD). Default exclusive, promoteAfter 1\n\
+		-u <name=lo:hi:steps,...>  tune policy parameters by successive halving\n\
+		    on trace prefixes, for each size of -s <size,size,...>. Tunables:\n\
+		    LIRS hirShare, CACHEUS historyFraction and alpha, ARC ghostFactor\n\
+		-j <threads>  parallel evaluations while tuning, default all cores\n\
+		-C <policy,policy,...>  classify each policy's misses as compulsory,\n\
+		    capacity (MIN misses too) or policy (MIN hits), for each size\n\
+		    of -s <size,size,...>; replaces -m\n\
+		-l <file>  binary log of every hit, miss and eviction (with its list)\n\
+		-S <every>[,file]  sample ARC, LIRS or CACHEUS internal state every\n\
+		    <every> references into a CSV, default Telemetry_<policy>_<size>.csv\n\
+		-H <regionMB>[,windowSeconds]  per-region calls, hits and dirty\n\
+		    evictions for each window of trace time into Heatmap.csv,\n\
+		    default window 3600\n\
+		-b <thresholdKB>[,streamsPerDisk]  sequential stream detection, -f 2:\n\
+		    misses of streams longer than the threshold bypass the cache,\n\
+		    compared with the plain policy; default 16 streams per disk\n\
+		-R <maxKB>  ondemand readahead per disk with windows up to maxKB,\n\
+		    -f 2; prefetched pages go through the policy's prefetch hook\n\
+		    (LRU, ARC: no call counted, no adaptation), compared with the\n\
+		    plain policy\n\
+		-O <speedup>[,clients[,missUs[,shards]]]  open-loop replay, -f 2:\n\
+		    requests arrive at their timestamps / speedup (0: all at once)\n\
+		    and are served by client threads from a sharded thread-safe\n\
+		    cache; misses wait missUs. Reports throughput and response and\n\
+		    queueing percentiles. Default 8 clients, 100us, 16 shards\n\
+		-n <multiple>  LIRS keeps at most multiple x size non-resident pages\n\
+		    exactly; older ones become fingerprints. Reports the memory\n\
+		-P <interval>  partition the cache between the (device, disk) pairs\n\
+		    of a merged MSR trace, UCP repartitioning every <interval>\n\
+		    references (0: max(10000, 10 x size)); LRU, LFU, ARC, LIRS,\n\
+		    CACHEUS. Compared with one shared cache of the same size\n\
+		", pgmname, pgmname);
 	exit(1);
 }
 
@@ -46,46 +272,42 @@ int main(int argc, char* argv[])
 	srand((unsigned int)time(NULL));
 
 
-	// read timestamp
-	double timestamp2;
-	// read key (or offset or address)
-	long long int key;
 	int j = 0;
 	pgmname = argv[j++];
 	string cache_policy;
 	int trace_type = 0;
-	char AccessPattern;
-	char* filename;
-	std::string operation = "Write";
+	char* filename = NULL;
 
-	long long int timestamp;
-	string device;
-	int disk;
-	string rwtype;
-	long long int offset;
-	int size;
-
-	int csize;
+	int csize = 0;
 
 	bool LRU = false;
-	bool LIRS = false;
-	bool MRU = false; 
-	bool LFU = false; 
-	bool MQ = false;
 	bool ARC = false;
-	bool LeCaR = false; 
-	bool HARC = false;
-	bool Exp = false;
-	bool CACHEUS = false;
-
-
-	string temp1;
-	string temp2;
-	string temp3;
-	string temp4;
-	string temp5;
-	string temp6;
-	string temp7;
+	bool Analyze = false;
+	bool OPT = false;
+	bool Dump = false;
+	bool extentMode = false;
+	double dirtyRatio = 0;
+	string deviceName;
+	int queueDepth = 0;
+	string admission;
+	string ghostMode;
+	bool timing = false;
+	unsigned seed = 42;
+	bool perf = false;
+	string tierSpec;
+	string tuneSpec;
+	string sizeArg;
+	string eventLogPath;
+	string heatmapSpec;
+	string classifySpec;
+	string telemetrySpec;
+	long long partitionInterval = -1;
+	string bypassSpec;
+	int readaheadKB = 0;
+	string openLoopSpec;
+	double lirsHistory = 0;
+	int threads = (int)std::thread::hardware_concurrency();
+
 	// open input file
 	if(j >= argc)
 	{
@@ -102,20 +324,17 @@ int main(int argc, char* argv[])
 			usage();
 		    }
 		    cache_policy = argv[j++];
-		    if(cache_policy == "LRU") LRU = true;    //LRUCache ca(CACHESIZE*1024*1024*2);
-		    else if(cache_policy == "LFU") LFU = true; //LFUCache ca(CACHESIZE*1024*1024*2);
-		    else if(cache_policy == "LIRS") LIRS = true; //LIRSCache
-		    else if(cache_policy == "ARC") ARC = true; //ARCache ca(CACHESIZE*1024*1024*2);
-		    else if(cache_policy == "MRU")  MRU = true; //MRUCache ca(CACHESIZE*1024*1024*2);
-		    else if(cache_policy == "MQ") MQ = true; //MQCache ca(CACHESIZE*1024*1024*2);
-		    else if(cache_policy == "LeCaR") LeCaR = true;//LeCaRCache ca(CACHESIZE*1024*1024*2);
-		    else if(cache_policy == "HARC") HARC = true;//LeCaRCache ca(CACHESIZE*1024*1024*2);
-		    else if(cache_policy == "Exp") Exp = true;//ExpCache ca(CACHESIZE*1024*1024*2);
-		    else if(cache_policy == "CACHEUS") CACHEUS = true;//CACHEUSCache ca(CACHESIZE*1024*1024*2);
-		    else{
+		    // policies are built by makePolicy; only the modes main
+		    // itself dispatches on keep a flag
+		    if(!knownPolicy(cache_policy)) {
 			fprintf(stderr, "Wrong cache type\n");
 			usage();
 		    }
+		    LRU = cache_policy == "LRU";
+		    ARC = cache_policy == "ARC";
+		    Analyze = cache_policy == "analyze";
+		    OPT = cache_policy == "OPT";
+		    Dump = cache_policy == "dump";
 		}
 		else{
 		    if(strcmp(argv[j], "-f") == 0)
@@ -145,9 +364,161 @@ int main(int argc, char* argv[])
 				    fprintf(stderr, "miss cache size\n");
 				    usage();
 				}
+				sizeArg = argv[j];
 				csize = atoi(argv[j++]);
-				break;
 
+			} else if (strcmp(argv[j], "-e") == 0) {
+				extentMode = true;
+				j++;
+			} else if (strcmp(argv[j], "-w") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the dirty ratio to -w\n");
+				    usage();
+				}
+				dirtyRatio = atof(argv[j++]);
+			} else if (strcmp(argv[j], "-d") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply SSD or HDD to -d\n");
+				    usage();
+				}
+				deviceName = argv[j++];
+			} else if (strcmp(argv[j], "-q") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the queue depth to -q\n");
+				    usage();
+				}
+				queueDepth = atoi(argv[j++]);
+			} else if (strcmp(argv[j], "-a") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the admission filter to -a\n");
+				    usage();
+				}
+				admission = argv[j++];
+				if (admission != "TinyLFU") {
+				    fprintf(stderr, "Wrong admission filter\n");
+				    usage();
+				}
+			} else if (strcmp(argv[j], "-g") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply compact or compare to -g\n");
+				    usage();
+				}
+				ghostMode = argv[j++];
+				if (ghostMode != "compact" && ghostMode != "compare") {
+				    fprintf(stderr, "Wrong ghost mode\n");
+				    usage();
+				}
+			} else if (strcmp(argv[j], "-t") == 0) {
+				timing = true;
+				j++;
+			} else if (strcmp(argv[j], "-u") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the parameter ranges to -u\n");
+				    usage();
+				}
+				tuneSpec = argv[j++];
+			} else if (strcmp(argv[j], "-j") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the number of threads to -j\n");
+				    usage();
+				}
+				threads = atoi(argv[j++]);
+			} else if (strcmp(argv[j], "-T") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the upper tier size to -T\n");
+				    usage();
+				}
+				tierSpec = argv[j++];
+			} else if (strcmp(argv[j], "-l") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the event log file to -l\n");
+				    usage();
+				}
+				eventLogPath = argv[j++];
+			} else if (strcmp(argv[j], "-C") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the policies to -C\n");
+				    usage();
+				}
+				classifySpec = argv[j++];
+				cache_policy = classifySpec;
+			} else if (strcmp(argv[j], "-S") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the sampling interval to -S\n");
+				    usage();
+				}
+				telemetrySpec = argv[j++];
+			} else if (strcmp(argv[j], "-H") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the region size to -H\n");
+				    usage();
+				}
+				heatmapSpec = argv[j++];
+			} else if (strcmp(argv[j], "-b") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the stream length threshold to -b\n");
+				    usage();
+				}
+				bypassSpec = argv[j++];
+			} else if (strcmp(argv[j], "-R") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the maximum readahead window to -R\n");
+				    usage();
+				}
+				readaheadKB = atoi(argv[j++]);
+				if (readaheadKB <= 0) {
+				    fprintf(stderr, "Wrong readahead window\n");
+				    usage();
+				}
+			} else if (strcmp(argv[j], "-O") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the speedup to -O\n");
+				    usage();
+				}
+				openLoopSpec = argv[j++];
+			} else if (strcmp(argv[j], "-n") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the history bound to -n\n");
+				    usage();
+				}
+				lirsHistory = atof(argv[j++]);
+				if (lirsHistory <= 0) {
+				    fprintf(stderr, "Wrong history bound\n");
+				    usage();
+				}
+			} else if (strcmp(argv[j], "-P") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the repartition interval to -P\n");
+				    usage();
+				}
+				partitionInterval = atoll(argv[j++]);
+			} else if (strcmp(argv[j], "-p") == 0) {
+				perf = true;
+				j++;
+			} else if (strcmp(argv[j], "-r") == 0) {
+				if(++ j >= argc)
+				{
+				    fprintf(stderr, "supply the seed to -r\n");
+				    usage();
+				}
+				seed = (unsigned)strtoul(argv[j++], NULL, 10);
 			} else{
 			    fprintf(stderr, "missing option\n");
 			    usage();
@@ -158,273 +529,382 @@ int main(int argc, char* argv[])
 	}
 
 
-	std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
-	if (result.is_open()) { 
-		result <<  filename << " ";			
+	if (filename == NULL) {
+		fprintf(stderr, "no input given, use -i\n");
+		usage();
+	}
+	// result rows name the trace; a pipe has no name of its own
+	const char* traceName = strcmp(filename, "-") == 0 ? "stdin" : filename;
+	recordFilename(traceName);
+	if (Dump) {
+		return dumpEventLog(filename) == 0 ? 0 : -1;
 	}
-	result.close();
-
 
-	std::ifstream myfile(filename);
+	TraceReader trace(filename, trace_type);
 	// check the open is succeeded
-	std::cout <<"File: "<< filename<< " "<<"Policy: "<<cache_policy<< "  " <<"Cache size: "<< csize <<std::endl;
-	int count = 0;
-	//LRU example
-	if(LRU){
+	std::cout <<"File: "<< traceName<< " "<<"Policy: "<<cache_policy<< "  " <<"Cache size: "<< csize <<std::endl;
+	if (extentMode) {
+		if (trace_type != 2 || !(LRU || ARC)) {
+			fprintf(stderr, "extent mode needs -f 2 and -m LRU or ARC\n");
+			usage();
+		}
+		// capacity is given in 4KB pages so the usual size sweep applies
+		if (LRU) {
+			ExtentLRUCache ca((long long)csize * 4 * 1024);
+			return replayExtents(ca, trace);
+		}
+		ExtentARCCache ca((long long)csize * 4 * 1024);
+		return replayExtents(ca, trace);
+	}
 
+	if (Analyze) {
+		TraceAnalyzer analyzer;
+		if (replay(trace, trace_type, analyzer, analyzer, NULL) != 0) return -1;
+		analyzer.report();
+		return 0;
+	}
+	if (OPT) {
+		// records the whole trace first, the simulation runs in report()
+		BeladyOPT opt(csize);
+		ObserverList none;
+		if (replay(trace, trace_type, opt, none, NULL) != 0) return -1;
+		opt.report();
+		recordFilename(traceName);
+		opt.reportCleanFirst();
+		return 0;
+	}
 
-		LRUCache ca(csize);
-		if (myfile.is_open()) {
-			while(!myfile.eof())
-			{
-			    
-				if(trace_type == 2){  // for MSR traces                
-					getline(myfile,temp1,','); //timestamp
-					getline(myfile,temp2,',');  //device
-					getline(myfile,temp3,',');  //disk
-					getline(myfile,temp4,','); //read or write
-					getline(myfile,temp5,',');  //offset   
-					getline(myfile,temp6,',');  //request size
-					getline(myfile,temp7);  //temp
-					if (!temp1.empty()){
-					   
-					    timestamp = std::stoll(temp1);
-					    
-					    device = temp2;
-					    disk = std::stoi(temp3);
-					    rwtype = temp4;
-					    offset = std::stoll(temp5);;
-					    size = std::stoi(temp6);
-					    //temp7 = std::stoi(temp7);
-					    
-					    //request unit: 0.5KB 
-					    for(int i = 0; i< (int)ceil(size/(4.0*1024)); i ++){
-						ca.refer(offset + i*1024*4, rwtype); 
-					    }
-					    //std::cout << timestamp<< " "<< device<<" "<< disk<<" "<< rwtype<<" " <<offset<<" " <<size<<" " <<temp7<< std::endl;
-					    //std::cout << count<< " " << temp1<< " "<< temp2<<" "<< temp3<<" "<< temp4<<" "<<temp5<<" "<<temp6<<" "<<temp7<< std::endl;
-					    count = count + 1; 
-					    
-					    
-					}
-			       
-				}else{    // for TPC-H traces
-						while (myfile >> timestamp2 >> key >> AccessPattern) {
-							ca.refer(key, rwtype);
-						}
-					}
+	PolicyParams params;
+	params.compactGhosts = !ghostMode.empty();
+	params.seed = seed;
+	params.lirsHistory = lirsHistory;
+
+	if (!classifySpec.empty()) {
+		vector<string> policies;
+		for (size_t at = 0; at != string::npos;) {
+			size_t comma = classifySpec.find(',', at);
+			policies.push_back(classifySpec.substr(at, comma == string::npos ? string::npos : comma - at));
+			at = comma == string::npos ? comma : comma + 1;
+		}
+		for (size_t i = 0; i < policies.size(); i++) {
+			CachePolicy* probe = makePolicy(policies[i], 1, params);
+			if (!probe) {
+				fprintf(stderr, "Wrong cache type %s\n", policies[i].c_str());
+				usage();
 			}
-		}else{
-		std::cerr << "error: unable to open input file" << std::endl;
-			return -1;
+			delete probe;
 		}
-
-
-		// print cache hit
-
-		ca.cachehits();
-		std::cout << std::endl;
-		// close the input file 
-		myfile.close();
-	}
-	else if (LFU) {
-		//std::ifstream myfile(filename);
-		LFUCache lfu_cache(csize);
-
-		if (myfile.is_open()) {
-			while (!myfile.eof()) {
-				if (trace_type == 2) {  // for MSR traces
-					getline(myfile, temp1, ','); //timestamp
-					getline(myfile, temp2, ','); //device
-					getline(myfile, temp3, ','); //disk
-					getline(myfile, temp4, ','); //read or write
-					getline(myfile, temp5, ','); //offset
-					getline(myfile, temp6, ','); //request size
-					getline(myfile, temp7); //temp
-					if (!temp1.empty()) {
-						timestamp = std::stoll(temp1);
-						device = temp2;
-						disk = std::stoi(temp3);
-						rwtype = temp4;
-						offset = std::stoll(temp5);
-						size = std::stoi(temp6);
-						//temp7 = std::stoi(temp7);
-
-						//request unit: 0.5KB
-						for (int i = 0; i < (int)ceil(size / (4.0 * 1024)); i++) {
-							lfu_cache.refer(offset + i * 1024 * 4, rwtype);
-						}
-						count = count + 1;
-					}
-				}
-				else {    // for TPC-H traces
-					while (myfile >> timestamp2 >> key >> AccessPattern) {
-						// set rwtype based on AccessPattern
-						// if (AccessPattern == 'R' || AccessPattern == 'r') rwtype = "Read";
-						// else rwtype = "Write";
-						lfu_cache.refer(key, rwtype);
-					}
-				}
+		vector<int> sizes = parseSizes(sizeArg);
+		MissClassifier classifier(makePolicy, params);
+		ObserverList none;
+		if (replay(trace, trace_type, classifier, none, NULL) != 0) return -1;
+		bool first = true;
+		for (size_t s = 0; s < sizes.size(); s++) {
+			for (size_t i = 0; i < policies.size(); i++) {
+				if (!first) recordFilename(traceName);
+				first = false;
+				classifier.classify(policies[i], sizes[s]);
 			}
 		}
-		else {
-			std::cerr << "error: unable to open input file" << std::endl;
-			return -1;
+		return 0;
+	}
+
+	if (partitionInterval >= 0) {
+		CachePolicy* probe = makePolicy(cache_policy, 1, params);
+		bool resizable = probe && probe->canResize();
+		delete probe;
+		if (trace_type != 2 || !resizable) {
+			fprintf(stderr, "-P needs -f 2 and a policy that can be resized (LRU, LFU, ARC, LIRS, CACHEUS)\n");
+			usage();
 		}
+		PartitionedCache part(makePolicy, params, cache_policy, csize, partitionInterval);
+		if (replayTenants(part, trace) != 0) return -1;
+		vector<string> names;
+		for (int t = 0; t < trace.tenants(); t++) names.push_back(trace.tenantName(t));
+		part.report(names);
+		return 0;
+	}
 
-		// print cache hit
-		lfu_cache.cacheHits();
-		std::cout << std::endl;
-		// close the input file
-		myfile.close();
-	}
-	else if (LIRS) {
-		LIRSCache lirs_cache(csize);
-
-		if (myfile.is_open()) {
-			while (!myfile.eof()) {
-				if (trace_type == 2) {  // for MSR traces
-					getline(myfile, temp1, ','); //timestamp
-					getline(myfile, temp2, ','); //device
-					getline(myfile, temp3, ','); //disk
-					getline(myfile, temp4, ','); //read or write
-					getline(myfile, temp5, ','); //offset
-					getline(myfile, temp6, ','); //request size
-					getline(myfile, temp7); //temp
-					if (!temp1.empty()) {
-						timestamp = std::stoll(temp1);
-						device = temp2;
-						disk = std::stoi(temp3);
-						rwtype = temp4;
-						offset = std::stoll(temp5);
-						size = std::stoi(temp6);
-						//temp7 = std::stoi(temp7);
-
-						//request unit: 0.5KB
-						for (int i = 0; i < (int)ceil(size / (4.0 * 1024)); i++) {
-							lirs_cache.refer(offset + i * 1024 * 4, rwtype);
-						}
-						count = count + 1;
-					}
-				}
-				else {    // for TPC-H traces
-					while (myfile >> timestamp2 >> key >> AccessPattern) {
-						lirs_cache.refer(key, rwtype);
-					}
-				}
-			}
+	if (!openLoopSpec.empty()) {
+		// <speedup>[,clients[,missUs[,shards]]]
+		OpenLoopConfig config;
+		const char* at = openLoopSpec.c_str();
+		double* fields[] = { &config.speedup, NULL, &config.missUs, NULL };
+		for (int f = 0; f < 4 && at; f++) {
+			if (f == 1) config.clients = atoi(at);
+			else if (f == 3) config.shards = atoi(at);
+			else *fields[f] = atof(at);
+			at = strchr(at, ',');
+			if (at) at++;
+		}
+		if (trace_type != 2 || config.speedup < 0 || config.clients <= 0 || config.missUs < 0 || config.shards <= 0) {
+			fprintf(stderr, "-O needs -f 2, a speedup >= 0 and positive clients and shards\n");
+			usage();
+		}
+		ShardedCache cache(makePolicy, params, cache_policy, csize, config.shards);
+		if (!cache.ok()) {
+			fprintf(stderr, "Wrong cache type %s\n", cache_policy.c_str());
+			usage();
 		}
-		else {
-			std::cerr << "error: unable to open input file" << std::endl;
-			return -1;
+		OpenLoopReplay driver(cache, cache_policy, csize, config);
+		if (driver.run(trace) != 0) return -1;
+		driver.report();
+		return 0;
+	}
+
+	if (!tuneSpec.empty()) {
+		vector<TuneRange> ranges;
+		if (!parseTuneRanges(tuneSpec, cache_policy, ranges)) usage();
+		vector<int> sizes = parseSizes(sizeArg);
+		RecordingPolicy recorded;
+		ObserverList none;
+		if (replay(trace, trace_type, recorded, none, NULL) != 0) return -1;
+		PolicyTuner tuner(cache_policy, makePolicy, params, ranges, recorded.keys, recorded.writes, threads);
+		for (size_t i = 0; i < sizes.size(); i++) {
+			if (i > 0) recordFilename(traceName);
+			tuner.tune(sizes[i]);
 		}
+		return 0;
+	}
 
-		// print cache hit
-		lirs_cache.cacheHitsResult();
-		std::cout << std::endl;
-		// close the input file
-		myfile.close();
-	}
-	else if (ARC) {
-		ARCCache arc_cache(csize);
-
-		if (myfile.is_open()) {
-			while (!myfile.eof()) {
-				if (trace_type == 2) {  // for MSR traces
-					getline(myfile, temp1, ','); //timestamp
-					getline(myfile, temp2, ','); //device
-					getline(myfile, temp3, ','); //disk
-					getline(myfile, temp4, ','); //read or write
-					getline(myfile, temp5, ','); //offset
-					getline(myfile, temp6, ','); //request size
-					getline(myfile, temp7); //temp
-					if (!temp1.empty()) {
-						timestamp = std::stoll(temp1);
-						device = temp2;
-						disk = std::stoi(temp3);
-						rwtype = temp4;
-						offset = std::stoll(temp5);
-						size = std::stoi(temp6);
-						//temp7 = std::stoi(temp7);
-
-						//request unit: 0.5KB
-						for (int i = 0; i < (int)ceil(size / (4.0 * 1024)); i++) {
-							arc_cache.refer(offset + i * 1024 * 4, rwtype);
-						}
-						count = count + 1;
-					}
-				}
-				else {    // for TPC-H traces
-					while (myfile >> timestamp2 >> key >> AccessPattern) {
-						arc_cache.refer(key, rwtype);
-					}
-				}
-			}
+	CachePolicy* ca = NULL;
+	if (!tierSpec.empty()) {
+		// <upperPages>[,inclusive|exclusive[,promoteAfter]]
+		int upperSize = atoi(tierSpec.c_str());
+		string placement = "exclusive";
+		int promoteAfter = 1;
+		size_t c1 = tierSpec.find(',');
+		if (c1 != string::npos) {
+			size_t c2 = tierSpec.find(',', c1 + 1);
+			placement = tierSpec.substr(c1 + 1, c2 == string::npos ? string::npos : c2 - c1 - 1);
+			if (c2 != string::npos) promoteAfter = atoi(tierSpec.c_str() + c2 + 1);
 		}
-		else {
-			std::cerr << "error: unable to open input file" << std::endl;
-			return -1;
+		if (upperSize <= 0 || promoteAfter <= 0 || (placement != "inclusive" && placement != "exclusive")) {
+			fprintf(stderr, "Wrong tier specification %s\n", tierSpec.c_str());
+			usage();
+		}
+		if (!admission.empty() || !bypassSpec.empty() || readaheadKB > 0) {
+			fprintf(stderr, "-T cannot be combined with -a, -b or -R\n");
+			usage();
 		}
 
-		// print cache hit
-		arc_cache.cacheHitsSummary();
-		std::cout << std::endl;
-		// close the input file
-		myfile.close();
-	}
-	else if (CACHEUS) {
-		CACHEUSCache ca(csize);
-		if (myfile.is_open()) {
-			while (!myfile.eof()) {
-				if (trace_type == 2) {  // for MSR traces
-					getline(myfile, temp1, ','); //timestamp
-					getline(myfile, temp2, ','); //device
-					getline(myfile, temp3, ','); //disk
-					getline(myfile, temp4, ','); //read or write
-					getline(myfile, temp5, ','); //offset
-					getline(myfile, temp6, ','); //request size
-					getline(myfile, temp7); //temp
-					if (!temp1.empty()) {
-						timestamp = std::stoll(temp1);
-						device = temp2;
-						disk = std::stoi(temp3);
-						rwtype = temp4;
-						offset = std::stoll(temp5);
-						size = std::stoi(temp6);
-						//temp7 = std::stoi(temp7);
-
-						//request unit: 0.5KB
-						int i;
-						for (i = 0; i < (int)ceil(size / (4.0 * 1024)); i++) {
-							ca.refer(offset + i * 1024 * 4, rwtype);
-						}
-						count = count + 1;
-					}
-				}
-				else {    // for TPC-H traces
-					std::cout << "TPC-H trace" << std::endl;
-					while (myfile >> timestamp2 >> key >> AccessPattern) {
-						ca.refer(key, rwtype);
-					}
-				}
-			}
+		DeviceProfile backing;
+		DeviceProfile::byName(deviceName.empty() ? "SSD" : deviceName, backing);
+		TierCosts costs;
+		costs.upperUs = 0.5;
+		costs.lowerUs = 2.0;
+		costs.lowerWriteUs = 4.0;
+		costs.missUs = backing.seekUs + 4096.0 / (backing.transferMBps * 1024 * 1024) * 1e6;
+
+		CachePolicy* upper = makePolicy(cache_policy, upperSize, params);
+		CachePolicy* lower = makePolicy(cache_policy, csize, params);
+		if (upper && !upper->canRemove()) {
+			fprintf(stderr, "%s cannot move pages between tiers\n", cache_policy.c_str());
+			usage();
 		}
-		else {
-			std::cerr << "error: unable to open input file" << std::endl;
-			return -1;
+		if (upper) ca = new TieredCache(upper, lower, cache_policy, upperSize, csize,
+			placement == "inclusive", promoteAfter, costs);
+	} else if (!bypassSpec.empty()) {
+		// <thresholdKB>[,streamsPerDisk]
+		long long thresholdKB = atoll(bypassSpec.c_str());
+		int streams = 16;
+		size_t comma = bypassSpec.find(',');
+		if (comma != string::npos) streams = atoi(bypassSpec.c_str() + comma + 1);
+		if (thresholdKB <= 0 || streams <= 0 || trace_type != 2 || !admission.empty() || readaheadKB > 0) {
+			fprintf(stderr, "-b needs -f 2, a positive threshold and no -a or -R\n");
+			usage();
 		}
-		// print cache hit
-		ca.cacheHits();
-		std::cout << std::endl;
-		// close the input file
-		myfile.close();
+		CachePolicy* mainPolicy = makePolicy(cache_policy, csize, params);
+		CachePolicy* baseline = makePolicy(cache_policy, csize, params);
+		if (mainPolicy && baseline) ca = new StreamBypassCache(mainPolicy, baseline, cache_policy, csize,
+			thresholdKB * 1024, streams);
+	} else if (readaheadKB > 0) {
+		if (trace_type != 2 || !admission.empty()) {
+			fprintf(stderr, "-R needs -f 2 and no -a\n");
+			usage();
+		}
+		CachePolicy* mainPolicy = makePolicy(cache_policy, csize, params);
+		CachePolicy* baseline = makePolicy(cache_policy, csize, params);
+		if (mainPolicy && baseline) ca = new ReadaheadCache(mainPolicy, baseline, cache_policy, csize,
+			readaheadKB / 4);
+	} else if (admission == "TinyLFU") {
+		// the window takes its share out of the same capacity, and the
+		// main policy needs at least one page of its own
+		if (csize < 2) {
+			fprintf(stderr, "-a TinyLFU needs a cache of at least 2 pages\n");
+			usage();
+		}
+		int window = TinyLFUCache::windowFor(csize);
+		CachePolicy* mainPolicy = makePolicy(cache_policy, csize - window, params);
+		if (mainPolicy) ca = new TinyLFUCache(mainPolicy, cache_policy, csize, window);
+	} else {
+		ca = makePolicy(cache_policy, csize, params);
 	}
-	else{
+	if (ca == NULL) {
 		std::cout << "No cache policy selected" << std::endl;
 		std::cerr << "cannot find a proper cache policy" << std::endl;
+		return 0;
+	}
+
+	// simulators fed by the policy's hits, misses and evictions
+	ObserverList observers;
+	WriteBackFlusher* flusher = NULL;
+	if (dirtyRatio > 0) {
+		flusher = new WriteBackFlusher(csize, dirtyRatio);
+		observers.add(flusher);
+	}
+	DeviceModel* device = NULL;
+	if (!deviceName.empty()) {
+		DeviceProfile profile;
+		if (!DeviceProfile::byName(deviceName, profile)) {
+			fprintf(stderr, "unknown device %s\n", deviceName.c_str());
+			usage();
+		}
+		if (queueDepth > 0) profile.queueDepth = queueDepth;
+		device = new DeviceModel(profile);
+		observers.add(device);
 	}
 
+	// exact-ghost twin of the compact run, same references
+	CachePolicy* shadow = NULL;
+	HitCounter primaryHits, shadowHits;
+	if (ghostMode == "compare") {
+		PolicyParams exact = params;
+		exact.compactGhosts = false;
+		shadow = makePolicy(cache_policy, csize, exact);
+		shadow->setObserver(&shadowHits);
+		observers.add(&primaryHits);
+	}
+	RegionHeatmap* heatmap = NULL;
+	if (!heatmapSpec.empty()) {
+		// <regionMB>[,windowSeconds]
+		double regionMB = atof(heatmapSpec.c_str());
+		double windowSeconds = 3600;
+		size_t comma = heatmapSpec.find(',');
+		if (comma != string::npos) windowSeconds = atof(heatmapSpec.c_str() + comma + 1);
+		if (regionMB <= 0 || windowSeconds < 0) {
+			fprintf(stderr, "Wrong heatmap specification %s\n", heatmapSpec.c_str());
+			usage();
+		}
+		heatmap = new RegionHeatmap(traceName, cache_policy, csize,
+			(long long)(regionMB * 1024 * 1024), windowSeconds);
+		observers.add(heatmap);
+	}
+	TelemetrySampler* telemetry = NULL;
+	if (!telemetrySpec.empty()) {
+		// <every>[,file]; the sampled policy is the one doing the replacement
+		long long every = atoll(telemetrySpec.c_str());
+		size_t comma = telemetrySpec.find(',');
+		string path = comma != string::npos ? telemetrySpec.substr(comma + 1)
+			: "Telemetry_" + cache_policy + "_" + std::to_string(csize) + ".csv";
+		vector<string> fields;
+		ca->telemetryFields(fields);
+		if (every <= 0 || fields.empty()) {
+			fprintf(stderr, "-S needs a positive interval and -m ARC, LIRS or CACHEUS without -a or -T\n");
+			usage();
+		}
+		telemetry = new TelemetrySampler(ca, every, path);
+		if (!telemetry->ok()) {
+			fprintf(stderr, "cannot write telemetry to %s\n", path.c_str());
+			usage();
+		}
+		observers.add(telemetry);
+	}
+	EventLogWriter* eventLog = NULL;
+	if (!eventLogPath.empty()) {
+		eventLog = new EventLogWriter(eventLogPath, cache_policy, csize);
+		if (!eventLog->ok()) {
+			fprintf(stderr, "cannot write event log %s\n", eventLogPath.c_str());
+			usage();
+		}
+		observers.add(eventLog);
+	}
+	// counts the references the counters are divided by
+	PerfCounters* counters = NULL;
+	HitCounter perfRefs;
+	if (perf) {
+		counters = new PerfCounters();
+		if (!timing) observers.add(&perfRefs);
+	}
+	if (!observers.empty()) ca->setObserver(&observers);
+
+	double seconds = 0;
+	long long refs = 0;
+	if (timing) {
+		// request boundaries are not kept, so the request-driven
+		// simulators cannot run from the recorded references; the heatmap
+		// would see the requests but none of the accesses
+		if (flusher || device || shadow || heatmap) {
+			fprintf(stderr, "-t cannot be combined with -w, -d, -g compare or -H\n");
+			usage();
+		}
+		RecordingPolicy recorded;
+		if (replay(trace, trace_type, recorded, observers, NULL) != 0) return -1;
+		refs = recorded.keys.size();
+		if (counters) counters->start();
+		seconds = timedReplay(recorded, *ca);
+		if (counters) counters->stop();
+	} else {
+		if (counters) counters->start();
+		if (replay(trace, trace_type, *ca, observers, shadow) != 0) return -1;
+		if (counters) counters->stop();
+		refs = perfRefs.calls;
+	}
 
+	// print cache hit
+	ca->report();
+	std::cout << std::endl;
+	if (counters) {
+		recordFilename(traceName);
+		counters->report(cache_policy, csize, refs);
+	}
+	if (telemetry) {
+		telemetry->finish();
+	}
+	if (heatmap) {
+		heatmap->finish();
+		recordFilename(traceName);
+		heatmap->report();
+	}
+	if (eventLog) {
+		eventLog->finish();
+		recordFilename(traceName);
+		eventLog->report();
+	}
+	if (flusher) {
+		flusher->finish();
+		recordFilename(traceName);
+		flusher->report(cache_policy);
+	}
+	if (device) {
+		device->finish();
+		recordFilename(traceName);
+		device->report(cache_policy, csize);
+	}
+	if (timing) {
+		double rate = seconds > 0 ? refs / seconds : 0;
+		std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+		result << traceName << " Throughput " << cache_policy << " CacheSize " << csize
+			<< " refs " << refs << " seconds " << seconds << " refsPerSec " << rate << "\n";
+		std::cout << "Throughput refs " << refs << " seconds " << seconds
+			<< " refsPerSec " << rate << std::endl;
+	}
+	if (shadow) {
+		std::ofstream result("ExperimentalResult.txt", std::ios_base::app);
+		result << traceName << " GhostCompare " << cache_policy << " CacheSize " << csize
+			<< " exactHitRatio " << shadowHits.hitRatio()
+			<< " compactHitRatio " << primaryHits.hitRatio()
+			<< " hitRatioDeviation " << primaryHits.hitRatio() - shadowHits.hitRatio() << "\n";
+		std::cout << "GhostCompare exactHitRatio " << shadowHits.hitRatio()
+			<< " compactHitRatio " << primaryHits.hitRatio() << std::endl;
+	}
+	delete shadow;
+	delete flusher;
+	delete device;
+	delete counters;
+	delete eventLog;
+	delete heatmap;
+	delete telemetry;
+	delete ca;
 	return 0;
 }
-// }
@@ -0,0 +1,108 @@
+#include "missclass.h"
+
+#include <iostream>
+#include <fstream>
+
+using namespace std;
+
+// Reports whether the last reference hit
+class LastOutcome : public CacheObserver
+{
+public:
+    LastOutcome() : hit(false) {}
+    void onAccess(long long int addr, bool write, bool h) { hit = h; }
+    bool hit;
+};
+
+MissClassifier::MissClassifier(PolicyMaker make, const PolicyParams& params)
+    : make(make), params(params), finished(false), truncated(false), optSize(-1), optHits(0)
+{
+}
+
+MissClassifier::~MissClassifier()
+{
+}
+
+void MissClassifier::refer(long long int addr, string rw)
+{
+    bool write = (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    if (!trace.record(addr, write) && !truncated) {
+        cerr << "warning: trace too long for 32-bit positions, the classification uses the first "
+             << trace.length() << " references" << endl;
+        truncated = true;
+    }
+}
+
+void MissClassifier::runOPT(int csize)
+{
+    if (!finished) {
+        trace.finish();
+        finished = true;
+    }
+    optHit.assign((trace.length() + 63) / 64, 0);
+    MinSimulation opt(csize, trace.pages(), false);
+    trace.rewind();
+    uint32_t id, nextUse;
+    bool write;
+    for (uint32_t i = 0; trace.next(id, write, nextUse); i++) {
+        if (opt.access(id, write, nextUse)) optHit[i >> 6] |= 1ULL << (i & 63);
+    }
+    optHits = opt.hits;
+    optSize = csize;
+}
+
+void MissClassifier::classify(const string& policy, int csize)
+{
+    if (optSize != csize) runOPT(csize);
+
+    CachePolicy* ca = make(policy, csize, params);
+    if (!ca) {
+        cerr << "cannot classify the misses of " << policy << endl;
+        return;
+    }
+    LastOutcome outcome;
+    ca->setObserver(&outcome);
+
+    const string read = "Read", write = "Write";
+    long long calls = 0, hits = 0, compulsory = 0, capacity = 0, policyMisses = 0;
+    uint32_t seen = 0;      // pages touched so far, the next new id
+    uint32_t id, nextUse;
+    bool w;
+    trace.rewind();
+    for (uint32_t i = 0; trace.next(id, w, nextUse); i++) {
+        bool first = id == seen;
+        if (first) seen++;
+        ca->refer(trace.keyOf(id), w ? write : read);
+        calls++;
+        if (outcome.hit) {
+            hits++;
+        } else if (first) {
+            compulsory++;
+        } else if (optHit[i >> 6] >> (i & 63) & 1) {
+            policyMisses++;
+        } else {
+            capacity++;
+        }
+    }
+    delete ca;
+
+    long long misses = calls - hits;
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "MissClass " << policy
+            << " CacheSize " << csize
+            << " calls " << calls
+            << " hits " << hits
+            << " hitRatio " << (calls ? (double)hits / calls : 0.0)
+            << " optHitRatio " << (calls ? (double)optHits / calls : 0.0)
+            << " misses " << misses
+            << " compulsory " << compulsory
+            << " capacity " << capacity
+            << " policy " << policyMisses
+            << " policyShare " << (misses ? (double)policyMisses / misses : 0.0)
+            << endl;
+    }
+}
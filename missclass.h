@@ -0,0 +1,52 @@
+#ifndef _missclass_H
+#define _missclass_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "policy.h"
+#include "opt.h"
+#include "tune.h"
+using namespace std;
+
+/*
+   Three-C breakdown of a policy's misses. The trace is recorded once as a
+   NextUseTrace; page ids are handed out in order of first appearance, so
+   a reference is a first touch exactly when its id is the next unseen
+   one. For each cache size, MIN is run once and its hit or miss kept as
+   one bit per reference; every policy is then replayed over the same
+   stream and each of its misses counted as
+     compulsory  first touch of the page
+     capacity    MIN of the same size misses as well
+     policy      MIN would have hit: headroom for a better policy
+*/
+class MissClassifier : public CachePolicy
+{
+public:
+    MissClassifier(PolicyMaker make, const PolicyParams& params);
+    ~MissClassifier();
+
+    void refer(long long int addr, string rw);      // records only
+
+    // classify the misses of one policy at one size and print the row
+    void classify(const string& policy, int csize);
+
+    void report() {}
+    bool contains(long long int addr) { return false; }
+    long long int victim() { return -1; }
+
+private:
+    PolicyMaker make;
+    PolicyParams params;
+    NextUseTrace trace;
+    bool finished;
+    bool truncated;
+
+    int optSize;                // size optHit was computed for, -1 before
+    vector<uint64_t> optHit;    // MIN hit bit per reference
+    long long optHits;
+
+    void runOPT(int csize);
+};
+
+#endif
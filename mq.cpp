@@ -0,0 +1,208 @@
+#include "mq.h"
+
+#include <list>
+#include <unordered_map>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+struct MQCache::Impl
+{
+    static const int QUEUES = 8;
+
+    MQCache* owner = nullptr;
+
+    int c = 0;
+    int qoutCap = 0;
+    long long lifeTime = 0;
+    long long currentTime = 0;
+
+    long long calls = 0;
+    long long hits = 0;
+    long long readHits = 0;
+    long long writeHits = 0;
+    long long evictedDirtyPage = 0;
+    long long qoutHits = 0;
+    long long demotions = 0;
+
+    // each queue: MRU at front, LRU at back
+    list<long long> Q[QUEUES];
+
+    struct Entry {
+        int queue;
+        list<long long>::iterator pos;
+        long long freq;
+        long long expireTime;
+        bool dirty;
+    };
+    unordered_map<long long, Entry> table;
+
+    // history of evicted pages and their access counts, newest at front
+    list<pair<long long, long long> > Qout;
+    unordered_map<long long, list<pair<long long, long long> >::iterator> qoutPos;
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    static int queueFor(long long freq) {
+        int k = 0;
+        while (freq > 1 && k < QUEUES - 1) {
+            freq >>= 1;
+            k++;
+        }
+        return k;
+    }
+
+    void evict() {
+        int k = 0;
+        while (k < QUEUES && Q[k].empty()) k++;
+        if (k == QUEUES) return;
+
+        long long v = Q[k].back();
+        Q[k].pop_back();
+        auto it = table.find(v);
+        if (it->second.dirty) evictedDirtyPage++;
+        owner->notifyEvict(v, it->second.dirty, SEG_Q0 + k);
+
+        if ((int)Qout.size() >= qoutCap) {
+            qoutPos.erase(Qout.back().first);
+            Qout.pop_back();
+        }
+        Qout.push_front(make_pair(v, it->second.freq));
+        qoutPos[v] = Qout.begin();
+        table.erase(it);
+    }
+
+    // Demote the LRU page of each queue whose lifetime ran out
+    void adjust() {
+        for (int k = 1; k < QUEUES; k++) {
+            if (Q[k].empty()) continue;
+            long long b = Q[k].back();
+            Entry& e = table[b];
+            if (e.expireTime < currentTime) {
+                Q[k].pop_back();
+                Q[k - 1].push_front(b);
+                e.queue = k - 1;
+                e.pos = Q[k - 1].begin();
+                e.expireTime = currentTime + lifeTime;
+                demotions++;
+            }
+        }
+    }
+
+    bool access(long long k, const string& rw) {
+        calls++;
+        currentTime++;
+        bool write = isWrite(rw);
+        bool hit = false;
+
+        Entry e;
+        auto it = table.find(k);
+        if (it != table.end()) {
+            hit = true;
+            hits++;
+            if (write) writeHits++; else readHits++;
+            e = it->second;
+            Q[e.queue].erase(e.pos);
+            e.dirty = e.dirty || write;
+        } else {
+            if (c <= 0) return false;
+            if ((int)table.size() >= c) evict();
+            e.freq = 0;
+            e.dirty = write;
+            auto h = qoutPos.find(k);
+            if (h != qoutPos.end()) {
+                qoutHits++;
+                e.freq = h->second->second;
+                Qout.erase(h->second);
+                qoutPos.erase(h);
+            }
+        }
+
+        e.freq++;
+        e.queue = queueFor(e.freq);
+        Q[e.queue].push_front(k);
+        e.pos = Q[e.queue].begin();
+        e.expireTime = currentTime + lifeTime;
+        table[k] = e;
+
+        adjust();
+        return hit;
+    }
+};
+
+const int MQCache::Impl::QUEUES;
+
+MQCache::MQCache(int size)
+{
+    p = new Impl();
+    p->owner = this;
+    p->c = max(0, size);
+    // history four times the cache and a lifetime of one cache's worth of
+    // accesses, as suggested in the MQ paper
+    p->qoutCap = max(1, 4 * p->c);
+    p->lifeTime = max(1, p->c);
+    p->table.reserve(p->c + 1);
+    p->qoutPos.reserve(p->qoutCap + 1);
+}
+
+MQCache::~MQCache()
+{
+    delete p;
+}
+
+void MQCache::refer(long long int addr, string rw)
+{
+    bool hit = p->access(addr, rw);
+    notifyAccess(addr, Impl::isWrite(rw), hit);
+}
+
+bool MQCache::contains(long long int addr)
+{
+    return p->table.find(addr) != p->table.end();
+}
+
+long long int MQCache::victim()
+{
+    if ((int)p->table.size() < p->c) return -1;
+    for (int k = 0; k < Impl::QUEUES; k++) {
+        if (!p->Q[k].empty()) return p->Q[k].back();
+    }
+    return -1;
+}
+
+bool MQCache::remove(long long int addr, bool& dirty)
+{
+    // a moved page keeps no Qout history, it was not evicted
+    auto it = p->table.find(addr);
+    if (it == p->table.end()) return false;
+    dirty = it->second.dirty;
+    p->Q[it->second.queue].erase(it->second.pos);
+    p->table.erase(it);
+    return true;
+}
+
+void MQCache::cacheHitsSummary()
+{
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "MQ CacheSize " << p->c
+            << " calls " << p->calls
+            << " hits " << p->hits
+            << " hitRatio " << (p->calls ? (double)p->hits / p->calls : 0.0)
+            << " readHits " << p->readHits
+            << " readHitRatio " << (p->calls ? (double)p->readHits / p->calls : 0.0)
+            << " writeHits " << p->writeHits
+            << " writeHitRatio " << (p->calls ? (double)p->writeHits / p->calls : 0.0)
+            << " evictedDirtyPage " << p->evictedDirtyPage
+            << " qoutHits " << p->qoutHits
+            << " demotions " << p->demotions
+            << endl;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef _mq_H
+#define _mq_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   Multi-Queue (Zhou, Philbin, Li): QUEUES LRU queues, a page with access
+   count f lives in queue min(log2(f), QUEUES-1). A page that is not
+   referenced for lifeTime accesses is demoted one queue. Evicted pages
+   keep their count in a bounded history (Qout), so a page coming back
+   re-enters at its old level. Suited to second-level caches where the
+   host cache has already absorbed most of the recency.
+*/
+class MQCache : public CachePolicy
+{
+public:
+    MQCache(int);
+    ~MQCache();
+
+    void refer(long long int addr, string rw);
+
+    void cacheHitsSummary();
+    void report() { cacheHitsSummary(); }
+    bool contains(long long int addr);
+    long long int victim();
+    bool remove(long long int addr, bool& dirty);
+    bool canRemove() const { return true; }
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,222 @@
+#include "openloop.h"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static const size_t MAX_QUEUED = 1 << 16;       // arrivals waiting for a client
+static const double TICKS_PER_US = 10.0;        // MSR timestamps are 100ns units
+static const double SPIN_US = 200;
+
+// sleep_until() wakes up tens of microseconds late, which would show up
+// as skew in the arrival times; the dispatcher sleeps most of the way,
+// then spins
+static void waitUntil(Clock::time_point t)
+{
+    Clock::time_point wake = t - chrono::duration_cast<Clock::duration>(chrono::duration<double, micro>(SPIN_US));
+    if (wake > Clock::now()) this_thread::sleep_until(wake);
+    while (Clock::now() < t) this_thread::yield();
+}
+
+struct OpenLoopReplay::Impl
+{
+    ShardedCache* cache = nullptr;
+    string policy;
+    int csize = 0;
+    OpenLoopConfig config;
+
+    struct Arrival {
+        TraceRecord r;
+        Clock::time_point due;
+    };
+    deque<Arrival> queue;
+    mutex lock;
+    condition_variable arrived, drained;
+    bool done = false;
+
+    // per client, merged by report()
+    struct Samples {
+        vector<float> responseUs, queueUs;
+        long long missRequests = 0;
+    };
+    vector<Samples> samples;
+
+    long long requests = 0;
+    double traceSeconds = 0;    // arrival span in trace time
+    double seconds = 0;         // wall time of the replay
+
+    void client(Samples& out) {
+        for (;;) {
+            Arrival a;
+            {
+                unique_lock<mutex> hold(lock);
+                arrived.wait(hold, [this] { return !queue.empty() || done; });
+                if (queue.empty()) return;
+                a = queue.front();
+                queue.pop_front();
+            }
+            drained.notify_one();
+
+            Clock::time_point start = Clock::now();
+            const string& rw = a.r.rwName();
+            int pages = (a.r.size + 4 * 1024 - 1) / (4 * 1024);
+            bool miss = false;
+            for (int i = 0; i < pages; i++) {
+                if (!cache->refer(a.r.offset + i * 1024 * 4, rw)) miss = true;
+            }
+            if (miss) {
+                out.missRequests++;
+                // a client blocked on I/O does not use a CPU, so it sleeps
+                // rather than spins; with more clients than cores spinning
+                // would measure the simulator's CPU contention instead
+                if (config.missUs > 0) {
+                    this_thread::sleep_for(chrono::duration_cast<Clock::duration>(
+                        chrono::duration<double, micro>(config.missUs)));
+                }
+            }
+            Clock::time_point end = Clock::now();
+            out.queueUs.push_back((float)chrono::duration<double, micro>(start - a.due).count());
+            out.responseUs.push_back((float)chrono::duration<double, micro>(end - a.due).count());
+        }
+    }
+};
+
+OpenLoopReplay::OpenLoopReplay(ShardedCache& cache, const string& policy, int csize,
+                               const OpenLoopConfig& config)
+{
+    p = new Impl();
+    p->cache = &cache;
+    p->policy = policy;
+    p->csize = csize;
+    p->config = config;
+    p->config.clients = max(1, config.clients);
+}
+
+OpenLoopReplay::~OpenLoopReplay()
+{
+    delete p;
+}
+
+int OpenLoopReplay::run(TraceReader& trace)
+{
+    if (!trace.ok()) {
+        cerr << "error: unable to open input file" << endl;
+        return -1;
+    }
+    p->samples.assign(p->config.clients, Impl::Samples());
+    vector<thread> clients;
+    for (int i = 0; i < p->config.clients; i++) {
+        clients.push_back(thread(&Impl::client, p, ref(p->samples[i])));
+    }
+
+    Clock::time_point start = Clock::now();
+    long long first = -1, last = -1;
+    TraceRecord r;
+    while (trace.next(r)) {
+        if (r.size <= 0) continue;
+        if (first < 0) first = r.timestamp;
+        last = max(last, r.timestamp);
+        Impl::Arrival a;
+        a.r = r;
+        a.due = start;
+        if (p->config.speedup > 0) {
+            double us = (r.timestamp - first) / TICKS_PER_US / p->config.speedup;
+            a.due = start + chrono::duration_cast<Clock::duration>(chrono::duration<double, micro>(us));
+            waitUntil(a.due);
+        }
+        {
+            // a full queue only holds the dispatcher back; the arrival
+            // keeps its scheduled time, so the wait still counts
+            unique_lock<mutex> hold(p->lock);
+            p->drained.wait(hold, [this] { return p->queue.size() < MAX_QUEUED; });
+            p->queue.push_back(a);
+        }
+        p->arrived.notify_one();
+        p->requests++;
+    }
+    {
+        lock_guard<mutex> hold(p->lock);
+        p->done = true;
+    }
+    p->arrived.notify_all();
+    for (size_t i = 0; i < clients.size(); i++) clients[i].join();
+
+    p->seconds = chrono::duration<double>(Clock::now() - start).count();
+    p->traceSeconds = first >= 0 ? (last - first) / TICKS_PER_US / 1e6 : 0.0;
+    return 0;
+}
+
+// value below which a fraction q of the sorted samples fall
+static double percentile(const vector<float>& sorted, double q)
+{
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)(q * (sorted.size() - 1) + 0.5);
+    return sorted[min(i, sorted.size() - 1)];
+}
+
+static double mean(const vector<float>& v)
+{
+    double sum = 0;
+    for (size_t i = 0; i < v.size(); i++) sum += v[i];
+    return v.empty() ? 0.0 : sum / v.size();
+}
+
+void OpenLoopReplay::report()
+{
+    vector<float> response, queued;
+    long long missRequests = 0;
+    for (size_t i = 0; i < p->samples.size(); i++) {
+        response.insert(response.end(), p->samples[i].responseUs.begin(), p->samples[i].responseUs.end());
+        queued.insert(queued.end(), p->samples[i].queueUs.begin(), p->samples[i].queueUs.end());
+        missRequests += p->samples[i].missRequests;
+    }
+    sort(response.begin(), response.end());
+    sort(queued.begin(), queued.end());
+
+    long long calls = p->cache->calls();
+    long long hits = p->cache->hits();
+    // the arrival rate asked for; 0 when everything arrives at once
+    double offered = p->config.speedup > 0 && p->traceSeconds > 0
+        ? p->requests / (p->traceSeconds / p->config.speedup) : 0.0;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "OpenLoop " << p->policy
+            << " CacheSize " << p->csize
+            << " shards " << p->cache->shards()
+            << " clients " << p->config.clients
+            << " speedup " << p->config.speedup
+            << " missUs " << p->config.missUs
+            << " requests " << p->requests
+            << " calls " << calls
+            << " hits " << hits
+            << " hitRatio " << (calls ? (double)hits / calls : 0.0)
+            << " missRequests " << missRequests
+            << " offeredIOPS " << offered
+            << " achievedIOPS " << (p->seconds > 0 ? p->requests / p->seconds : 0.0)
+            << " seconds " << p->seconds
+            << " responseMeanUs " << mean(response)
+            << " responseP50Us " << percentile(response, 0.5)
+            << " responseP90Us " << percentile(response, 0.9)
+            << " responseP99Us " << percentile(response, 0.99)
+            << " responseP999Us " << percentile(response, 0.999)
+            << " responseMaxUs " << (response.empty() ? 0.0 : response.back())
+            << " queueMeanUs " << mean(queued)
+            << " queueP50Us " << percentile(queued, 0.5)
+            << " queueP99Us " << percentile(queued, 0.99)
+            << endl;
+    }
+}
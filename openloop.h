@@ -0,0 +1,43 @@
+#ifndef _openloop_H
+#define _openloop_H
+
+#include <string>
+#include "sharded.h"
+#include "tracereader.h"
+using namespace std;
+
+struct OpenLoopConfig
+{
+    double speedup = 1;     // trace seconds per replay second; 0 issues everything at once
+    int clients = 8;        // threads serving requests
+    double missUs = 100;    // stand-in backend latency of a request with a miss
+    int shards = 16;
+};
+
+/*
+   Open-loop replay of an MSR trace against a ShardedCache. A dispatcher
+   releases every request at its trace timestamp (divided by the
+   speedup) no matter how far behind the clients are; client threads take
+   the requests in arrival order, reference their pages and, if any page
+   missed, wait out the backend latency. Response times are measured from
+   the scheduled arrival, so they include the time a request queued for
+   a free client; past the saturating load they grow with the backlog.
+*/
+class OpenLoopReplay
+{
+public:
+    OpenLoopReplay(ShardedCache& cache, const string& policy, int csize, const OpenLoopConfig& config);
+    ~OpenLoopReplay();
+
+    // replays the whole trace; -1 if it cannot be read
+    int run(TraceReader& trace);
+
+    // throughput and response/queueing percentiles
+    void report();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,283 @@
+#include "opt.h"
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <stdlib.h>
+#include <sys/types.h>
+
+using namespace std;
+
+const uint32_t NextUseTrace::NEVER;
+const size_t NextUseTrace::BLOCK;
+
+// Stream entries: page id in the low 31 bits, write flag in the top bit
+static const uint32_t WRITE_BIT = 0x80000000u;
+
+NextUseTrace::NextUseTrace()
+    : n(0), idFile(tmpfile()), nextFile(NULL), bufPos(0), readPos(0)
+{
+    if (!idFile) {
+        cerr << "error: cannot create a temporary file for the reference stream" << endl;
+        exit(1);
+    }
+    idBuf.reserve(BLOCK);
+}
+
+NextUseTrace::~NextUseTrace()
+{
+    if (idFile) fclose(idFile);
+    if (nextFile) fclose(nextFile);
+}
+
+void NextUseTrace::flushIds()
+{
+    if (idBuf.empty()) return;
+    fwrite(&idBuf[0], sizeof(uint32_t), idBuf.size(), idFile);
+    idBuf.clear();
+}
+
+bool NextUseTrace::record(long long key, bool write)
+{
+    if (n == NEVER - 1 || keys.size() == WRITE_BIT) return false;
+
+    uint32_t id;
+    auto it = ids.find(key);
+    if (it == ids.end()) {
+        id = (uint32_t)keys.size();
+        ids[key] = id;
+        keys.push_back(key);
+    } else {
+        id = it->second;
+    }
+    idBuf.push_back(id | (write ? WRITE_BIT : 0));
+    if (idBuf.size() == BLOCK) flushIds();
+    n++;
+    return true;
+}
+
+// Walk the id stream backwards one block at a time; the last position
+// seen for a page is the next use of the reference before it. The
+// next-use file is written block by block at the matching offsets.
+void NextUseTrace::finish()
+{
+    flushIds();
+    ids.clear();
+    nextFile = tmpfile();
+    if (!nextFile) {
+        cerr << "error: cannot create a temporary file for next uses" << endl;
+        exit(1);
+    }
+
+    vector<uint32_t> lastUse(keys.size(), NEVER);
+    vector<uint32_t> in(BLOCK), out(BLOCK);
+    size_t blocks = (n + BLOCK - 1) / BLOCK;
+    for (size_t b = blocks; b-- > 0;) {
+        size_t start = b * BLOCK;
+        size_t len = min((size_t)n - start, BLOCK);
+        off_t at = (off_t)start * sizeof(uint32_t);
+        fseeko(idFile, at, SEEK_SET);
+        if (fread(&in[0], sizeof(uint32_t), len, idFile) != len) {
+            cerr << "error: short read from the reference stream" << endl;
+            exit(1);
+        }
+        for (size_t i = len; i-- > 0;) {
+            uint32_t id = in[i] & ~WRITE_BIT;
+            out[i] = lastUse[id];
+            lastUse[id] = (uint32_t)(start + i);
+        }
+        fseeko(nextFile, at, SEEK_SET);
+        fwrite(&out[0], sizeof(uint32_t), len, nextFile);
+    }
+    fflush(nextFile);
+    rewind();
+}
+
+void NextUseTrace::rewind()
+{
+    fseeko(idFile, 0, SEEK_SET);
+    if (nextFile) fseeko(nextFile, 0, SEEK_SET);
+    idBuf.clear();
+    nextBuf.clear();
+    bufPos = 0;
+    readPos = 0;
+}
+
+bool NextUseTrace::next(uint32_t& id, bool& write, uint32_t& nextUse)
+{
+    if (readPos >= n) return false;
+    if (bufPos == idBuf.size()) {
+        size_t len = min((size_t)(n - readPos), BLOCK);
+        idBuf.resize(len);
+        nextBuf.resize(len);
+        if (fread(&idBuf[0], sizeof(uint32_t), len, idFile) != len
+            || fread(&nextBuf[0], sizeof(uint32_t), len, nextFile) != len) {
+            cerr << "error: short read from the next-use stream" << endl;
+            exit(1);
+        }
+        bufPos = 0;
+    }
+    id = idBuf[bufPos] & ~WRITE_BIT;
+    write = (idBuf[bufPos] & WRITE_BIT) != 0;
+    nextUse = nextBuf[bufPos];
+    bufPos++;
+    readPos++;
+    return true;
+}
+
+MinSimulation::MinSimulation(int capacity, uint32_t pages, bool cleanFirst)
+    : c(capacity), cleanFirst(cleanFirst), resident(0),
+      calls(0), hits(0), readHits(0), writeHits(0), evictedDirtyPage(0),
+      state(pages, 0), curNext(pages, NextUseTrace::NEVER)
+{
+}
+
+bool MinSimulation::access(uint32_t id, bool write, uint32_t nextUse)
+{
+    calls++;
+    bool hit = (state[id] & RESIDENT) != 0;
+    if (hit) {
+        hits++;
+        if (write) writeHits++; else readHits++;
+        if (write) state[id] |= DIRTY;
+    } else {
+        if (c <= 0) return false;
+        if (resident >= c) evict();
+        state[id] = RESIDENT | (write ? DIRTY : 0);
+        resident++;
+    }
+    curNext[id] = nextUse;
+    push(id);
+    return hit;
+}
+
+bool MinSimulation::valid(const Entry& e, int dirty) const
+{
+    uint8_t s = state[e.second];
+    return (s & RESIDENT) && ((s & DIRTY) != 0) == (dirty != 0) && curNext[e.second] == e.first;
+}
+
+void MinSimulation::push(uint32_t id)
+{
+    int d = (state[id] & DIRTY) ? 1 : 0;
+    heap[d].push_back(Entry(curNext[id], id));
+    push_heap(heap[d].begin(), heap[d].end());
+    if (heap[d].size() > 2 * (size_t)c + 1024) purge(d);
+}
+
+void MinSimulation::purge(int d)
+{
+    vector<Entry>& h = heap[d];
+    size_t keep = 0;
+    for (size_t i = 0; i < h.size(); i++) {
+        if (valid(h[i], d)) h[keep++] = h[i];
+    }
+    h.resize(keep);
+    make_heap(h.begin(), h.end());
+}
+
+const MinSimulation::Entry* MinSimulation::top(int d)
+{
+    vector<Entry>& h = heap[d];
+    while (!h.empty() && !valid(h.front(), d)) {
+        pop_heap(h.begin(), h.end());
+        h.pop_back();
+    }
+    return h.empty() ? NULL : &h.front();
+}
+
+void MinSimulation::evict()
+{
+    const Entry* clean = top(0);
+    const Entry* dirty = top(1);
+    int d;
+    if (!clean) d = 1;
+    else if (!dirty || cleanFirst) d = 0;
+    else d = dirty->first > clean->first ? 1 : 0;
+
+    uint32_t v = heap[d].front().second;
+    pop_heap(heap[d].begin(), heap[d].end());
+    heap[d].pop_back();
+    if (state[v] & DIRTY) evictedDirtyPage++;
+    state[v] = 0;
+    resident--;
+}
+
+struct BeladyOPT::Impl
+{
+    int c = 0;
+    NextUseTrace trace;
+    bool truncated = false;
+    MinSimulation* belady = nullptr;
+    MinSimulation* cleanFirst = nullptr;
+
+    ~Impl() {
+        delete belady;
+        delete cleanFirst;
+    }
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    static void summary(const char* name, const MinSimulation& s)
+    {
+        ofstream result("ExperimentalResult.txt", ios_base::app);
+        ostream* outs[2] = { &cout, &result };
+        for (int o = 0; o < 2; o++) {
+            ostream& out = *outs[o];
+            if (o == 1 && !result.is_open()) break;
+            out << name << " CacheSize " << s.c
+                << " calls " << s.calls
+                << " hits " << s.hits
+                << " hitRatio " << s.hitRatio()
+                << " readHits " << s.readHits
+                << " readHitRatio " << (s.calls ? (double)s.readHits / s.calls : 0.0)
+                << " writeHits " << s.writeHits
+                << " writeHitRatio " << (s.calls ? (double)s.writeHits / s.calls : 0.0)
+                << " evictedDirtyPage " << s.evictedDirtyPage
+                << endl;
+        }
+    }
+};
+
+BeladyOPT::BeladyOPT(int size)
+{
+    p = new Impl();
+    p->c = max(0, size);
+}
+
+BeladyOPT::~BeladyOPT()
+{
+    delete p;
+}
+
+void BeladyOPT::refer(long long int addr, string rw)
+{
+    if (!p->trace.record(addr, Impl::isWrite(rw)) && !p->truncated) {
+        cerr << "warning: trace too long for 32-bit positions, OPT uses the first "
+             << p->trace.length() << " references" << endl;
+        p->truncated = true;
+    }
+}
+
+void BeladyOPT::report()
+{
+    p->trace.finish();
+
+    p->belady = new MinSimulation(p->c, p->trace.pages(), false);
+    p->cleanFirst = new MinSimulation(p->c, p->trace.pages(), true);
+    uint32_t id, nextUse;
+    bool write;
+    while (p->trace.next(id, write, nextUse)) {
+        p->belady->access(id, write, nextUse);
+        p->cleanFirst->access(id, write, nextUse);
+    }
+
+    Impl::summary("OPT", *p->belady);
+}
+
+void BeladyOPT::reportCleanFirst()
+{
+    if (p->cleanFirst) Impl::summary("OPT-CleanFirst", *p->cleanFirst);
+}
@@ -0,0 +1,120 @@
+#ifndef _opt_H
+#define _opt_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdio.h>
+#include <stdint.h>
+#include "policy.h"
+using namespace std;
+
+/*
+   A recorded page-reference stream with the position of each reference's
+   next use, for offline analyses. Pages get dense 32-bit ids; the id
+   stream and the next-use stream live in temporary files read and written
+   in blocks, so only the per-page tables stay in memory and full MSR
+   traces fit.
+*/
+class NextUseTrace
+{
+public:
+    static const uint32_t NEVER = 0xFFFFFFFFu;
+
+    NextUseTrace();
+    ~NextUseTrace();
+
+    bool record(long long key, bool write);    // false once the stream is too long
+    void finish();                             // reverse pass, computes next uses
+
+    uint32_t pages() const { return (uint32_t)keys.size(); }
+    uint32_t length() const { return n; }
+    long long keyOf(uint32_t id) const { return keys[id]; }
+
+    // forward scan after finish(); nextUse is a position or NEVER
+    void rewind();
+    bool next(uint32_t& id, bool& write, uint32_t& nextUse);
+
+private:
+    static const size_t BLOCK = 1 << 16;
+
+    unordered_map<long long, uint32_t> ids;
+    vector<long long> keys;
+    uint32_t n;
+
+    FILE* idFile;
+    FILE* nextFile;
+    vector<uint32_t> idBuf, nextBuf;
+    size_t bufPos;
+    uint32_t readPos;
+
+    void flushIds();
+};
+
+/*
+   One MIN simulation over a NextUseTrace. Resident pages sit in a clean
+   and a dirty max-heap keyed by next use; entries are never updated in
+   place, a page gets a new entry whenever its next use or dirty bit
+   changes and stale ones are skipped (and purged when the heaps outgrow
+   the cache). cleanFirst evicts dirty pages only when no clean one is
+   left.
+*/
+class MinSimulation
+{
+public:
+    MinSimulation(int capacity, uint32_t pages, bool cleanFirst);
+
+    // returns true on a hit
+    bool access(uint32_t id, bool write, uint32_t nextUse);
+
+    double hitRatio() const { return calls ? (double)hits / calls : 0.0; }
+
+    int c;
+    bool cleanFirst;
+    int resident;
+    long long calls, hits, readHits, writeHits, evictedDirtyPage;
+
+private:
+    enum { RESIDENT = 1, DIRTY = 2 };
+    typedef pair<uint32_t, uint32_t> Entry;   // next use, id
+
+    vector<uint8_t> state;
+    vector<uint32_t> curNext;
+    vector<Entry> heap[2];    // [0] clean, [1] dirty
+
+    bool valid(const Entry& e, int dirty) const;
+    void push(uint32_t id);
+    void purge(int d);
+    const Entry* top(int d);
+    void evict();
+};
+
+/*
+   Belady's MIN, offline: the resident page used furthest in the future is
+   evicted. -m OPT records the trace, then simulates two variants in a
+   single pass: plain MIN (the hit-ratio upper bound) and clean-first MIN,
+   which evicts the furthest clean page and falls back to dirty pages only
+   when every resident page is dirty. Clean-first is a greedy heuristic,
+   not a bound: it gives up hits to save dirty evictions and is not
+   proven to minimise them.
+*/
+class BeladyOPT : public CachePolicy
+{
+public:
+    BeladyOPT(int);
+    ~BeladyOPT();
+
+    void refer(long long int addr, string rw);     // records only
+
+    // runs both simulations and prints the MIN summary
+    void report();
+    void reportCleanFirst();
+    bool contains(long long int addr) { return false; }
+    long long int victim() { return -1; }
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,295 @@
+#include "partition.h"
+
+#include <iostream>
+#include <fstream>
+#include <list>
+#include <unordered_map>
+#include <algorithm>
+#include "hash.h"
+
+using namespace std;
+
+static const int MAX_UNITS = 64;        // capacity moves in 1/64 of the cache
+static const int MAX_SAMPLE = 32;       // at most one page in 32 is monitored
+static const int MAX_TENANTS = 32;      // later tenants share the last partition
+static const int TENANT_SHIFT = 48;     // byte offsets stay below 256TB
+
+// Offsets of different disks are different pages: the tenant goes into
+// the high bits of the key the shared cache and the policies see
+static long long pageKey(int tenant, long long addr)
+{
+    return (long long)((uint64_t)tenant << TENANT_SHIFT) ^ addr;
+}
+
+// Reports whether the last reference hit
+class LastHit : public CacheObserver
+{
+public:
+    LastHit() : hit(false) {}
+    void onAccess(long long int addr, bool write, bool h) { hit = h; }
+    bool hit;
+};
+
+/*
+   UCP utility monitor of one tenant: an LRU stack of sampled page keys
+   cut into one segment per unit of capacity. A hit in segment i would
+   have been a hit with i+1 or more units, so hits[i] is the marginal
+   gain of the (i+1)-th unit.
+*/
+class UtilityMonitor
+{
+public:
+    UtilityMonitor(int units, int segCap, int sampleShift)
+        : segs(units), hits(units, 0), segCap(segCap), mask((1ULL << sampleShift) - 1)
+    {
+    }
+
+    void access(long long key)
+    {
+        if (mix64((uint64_t)key) & mask) return;
+        auto it = where.find(key);
+        if (it != where.end()) {
+            int s = it->second.first;
+            hits[s]++;
+            segs[s].erase(it->second.second);
+        }
+        segs[0].push_front(key);
+        where[key] = make_pair(0, segs[0].begin());
+        // push the LRU end of every full segment into the next one
+        for (size_t s = 0; s < segs.size() && (int)segs[s].size() > segCap; s++) {
+            long long down = segs[s].back();
+            segs[s].pop_back();
+            if (s + 1 == segs.size()) {
+                where.erase(down);
+            } else {
+                segs[s + 1].push_front(down);
+                where[down] = make_pair((int)s + 1, segs[s + 1].begin());
+            }
+        }
+    }
+
+    // hits the first units units would have given
+    double utility(int units) const
+    {
+        double u = 0;
+        for (int i = 0; i < units; i++) u += hits[i];
+        return u;
+    }
+
+    void age()
+    {
+        for (size_t i = 0; i < hits.size(); i++) hits[i] /= 2;
+    }
+
+private:
+    vector<list<long long>> segs;
+    unordered_map<long long, pair<int, list<long long>::iterator>> where;
+    vector<double> hits;
+    int segCap;
+    uint64_t mask;
+};
+
+struct PartitionedCache::Impl
+{
+    PolicyMaker make;
+    PolicyParams params;
+    string policy;
+    int csize = 0;
+    long long interval = 0;
+    int units = 0;
+    int segCap = 0;
+    int sampleShift = 0;
+
+    struct Tenant {
+        CachePolicy* cache;
+        UtilityMonitor* umon;
+        int units;
+        long long calls, hits, sharedHits;
+        long long unitRefs;     // units held, summed over references
+    };
+    vector<Tenant> tenants;
+    LastHit lastHit, lastSharedHit;
+    CachePolicy* shared = NULL;
+
+    long long refs = 0;
+    long long repartitions = 0;
+    long long unitsMoved = 0;
+    bool merged = false;
+
+    // pages of tenant t: its units scaled to the cache, by cumulative
+    // units so that the partitions always add up to csize
+    int pages(size_t t) const
+    {
+        long long before = 0;
+        for (size_t i = 0; i < t; i++) before += tenants[i].units;
+        long long after = before + tenants[t].units;
+        return (int)(after * csize / units - before * csize / units);
+    }
+
+    void applySizes()
+    {
+        for (size_t t = 0; t < tenants.size(); t++) {
+            tenants[t].cache->resize(max(1, pages(t)));
+        }
+    }
+
+    void addTenant()
+    {
+        Tenant n;
+        n.umon = new UtilityMonitor(units, segCap, sampleShift);
+        n.calls = n.hits = n.sharedHits = n.unitRefs = 0;
+        if (tenants.empty()) {
+            n.units = units;
+        } else {
+            // the newcomer starts with a unit of the largest partition
+            size_t big = 0;
+            for (size_t t = 1; t < tenants.size(); t++) {
+                if (tenants[t].units > tenants[big].units) big = t;
+            }
+            tenants[big].units--;
+            n.units = 1;
+            unitsMoved++;
+        }
+        n.cache = make(policy, max(1, (int)((long long)n.units * csize / units)), params);
+        n.cache->setObserver(&lastHit);
+        tenants.push_back(n);
+        if (tenants.size() > 1) applySizes();
+    }
+
+    // UCP lookahead: hand out the units one grant at a time to the
+    // tenant and amount with the best hits per unit
+    void repartition()
+    {
+        vector<int> alloc(tenants.size(), 1);
+        int balance = units - (int)tenants.size();
+        while (balance > 0) {
+            double bestMu = 0;
+            int bestT = -1, bestA = 0;
+            for (size_t t = 0; t < tenants.size(); t++) {
+                double base = tenants[t].umon->utility(alloc[t]);
+                for (int a = 1; a <= balance && alloc[t] + a <= units; a++) {
+                    double mu = (tenants[t].umon->utility(alloc[t] + a) - base) / a;
+                    if (mu > bestMu) {
+                        bestMu = mu;
+                        bestT = (int)t;
+                        bestA = a;
+                    }
+                }
+            }
+            if (bestT < 0) break;
+            alloc[bestT] += bestA;
+            balance -= bestA;
+        }
+        // units nobody would gain from stay where they were, so a quiet
+        // window does not move capacity
+        for (size_t t = 0; t < alloc.size() && balance > 0; t++) {
+            int back = min(balance, tenants[t].units - alloc[t]);
+            if (back > 0) {
+                alloc[t] += back;
+                balance -= back;
+            }
+        }
+
+        for (size_t t = 0; t < tenants.size(); t++) {
+            if (alloc[t] > tenants[t].units) unitsMoved += alloc[t] - tenants[t].units;
+            tenants[t].units = alloc[t];
+            tenants[t].umon->age();
+        }
+        applySizes();
+        repartitions++;
+    }
+};
+
+PartitionedCache::PartitionedCache(PolicyMaker make, const PolicyParams& params, const string& policy,
+                                   int csize, long long interval)
+{
+    p = new Impl();
+    p->make = make;
+    p->params = params;
+    p->policy = policy;
+    p->csize = csize;
+    p->units = min(MAX_UNITS, max(1, csize));
+    p->interval = interval > 0 ? interval : max(10000LL, 10LL * csize);
+    // sample about 8 monitored pages per unit at least
+    int unit = csize / p->units;
+    while ((1 << p->sampleShift) < MAX_SAMPLE && (1 << (p->sampleShift + 1)) <= max(1, unit / 8)) p->sampleShift++;
+    p->segCap = max(1, unit >> p->sampleShift);
+    p->shared = make(policy, csize, params);
+    p->shared->setObserver(&p->lastSharedHit);
+}
+
+PartitionedCache::~PartitionedCache()
+{
+    for (size_t t = 0; t < p->tenants.size(); t++) {
+        delete p->tenants[t].cache;
+        delete p->tenants[t].umon;
+    }
+    delete p->shared;
+    delete p;
+}
+
+void PartitionedCache::refer(int tenant, long long addr, const string& rw)
+{
+    long long key = pageKey(tenant, addr);
+    int limit = min(MAX_TENANTS, p->units);
+    if (tenant >= limit) {
+        tenant = limit - 1;
+        p->merged = true;
+    }
+    while ((int)p->tenants.size() <= tenant) p->addTenant();
+
+    Impl::Tenant& t = p->tenants[tenant];
+    t.umon->access(key);
+    p->lastHit.hit = false;
+    t.cache->refer(key, rw);
+    p->lastSharedHit.hit = false;
+    p->shared->refer(key, rw);
+
+    t.calls++;
+    if (p->lastHit.hit) t.hits++;
+    if (p->lastSharedHit.hit) t.sharedHits++;
+    for (size_t i = 0; i < p->tenants.size(); i++) p->tenants[i].unitRefs += p->tenants[i].units;
+
+    if (++p->refs % p->interval == 0 && p->tenants.size() > 1) p->repartition();
+}
+
+void PartitionedCache::report(const vector<string>& names)
+{
+    long long calls = 0, hits = 0, sharedHits = 0;
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (size_t i = 0; i < p->tenants.size(); i++) {
+        const Impl::Tenant& t = p->tenants[i];
+        calls += t.calls;
+        hits += t.hits;
+        sharedHits += t.sharedHits;
+        string name = i < names.size() ? names[i] : "?";
+        if (p->merged && (int)i == (int)p->tenants.size() - 1) name += "+";
+        double avgPages = p->refs ? (double)t.unitRefs / p->refs * p->csize / p->units : 0.0;
+        for (int o = 0; o < 2; o++) {
+            ostream& out = *outs[o];
+            if (o == 1 && !result.is_open()) break;
+            out << "Partition " << p->policy
+                << " CacheSize " << p->csize
+                << " tenant " << name
+                << " calls " << t.calls
+                << " hits " << t.hits
+                << " hitRatio " << (t.calls ? (double)t.hits / t.calls : 0.0)
+                << " sharedHitRatio " << (t.calls ? (double)t.sharedHits / t.calls : 0.0)
+                << " pages " << p->pages(i)
+                << " avgPages " << avgPages << endl;
+        }
+    }
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "Partitioned " << p->policy
+            << " CacheSize " << p->csize
+            << " tenants " << p->tenants.size()
+            << " calls " << calls
+            << " hitRatio " << (calls ? (double)hits / calls : 0.0)
+            << " sharedHitRatio " << (calls ? (double)sharedHits / calls : 0.0)
+            << " repartitions " << p->repartitions
+            << " unitsMoved " << p->unitsMoved << endl;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef _partition_H
+#define _partition_H
+
+#include <string>
+#include <vector>
+#include "policy.h"
+#include "tune.h"
+using namespace std;
+
+/*
+   A cache split between tenants (the device and disk of MSR rows), each
+   with its own instance of the policy, repartitioned in the style of
+   Utility-based Cache Partitioning (UCP). Capacity moves in units of
+   1/64 of the cache. Every tenant has a utility monitor: LRU shadow tags
+   over a hash sample of its pages, cut into one segment per unit, that
+   count how many hits each additional unit would have given. Every
+   interval references the lookahead algorithm hands out the units by
+   marginal utility (every tenant keeps at least one), the partitions are
+   resized and the monitors' counters halved so they follow phase
+   changes. A shared cache of the full size runs alongside on the same
+   references as the baseline. Pages are keyed by tenant and offset, so
+   the same offset on two disks is two pages everywhere.
+*/
+class PartitionedCache
+{
+public:
+    PartitionedCache(PolicyMaker make, const PolicyParams& params, const string& policy,
+                     int csize, long long interval);
+    ~PartitionedCache();
+
+    void refer(int tenant, long long addr, const string& rw);
+
+    // one row per tenant, then the totals; names are indexed by tenant id
+    void report(const vector<string>& names);
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include "perfcounters.h"
+
+#include <iostream>
+#include <fstream>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+using namespace std;
+
+static const char* eventNames[] = {
+    "cycles", "instructions", "llcMisses", "dtlbMisses", "branchMisses"
+};
+
+const int PerfCounters::EVENTS;
+
+#ifdef __linux__
+static int openCounter(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // counters may be multiplexed, keep the times to scale them back
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static uint64_t cacheMiss(uint64_t cache)
+{
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+PerfCounters::PerfCounters()
+{
+    for (int i = 0; i < EVENTS; i++) {
+        fd[i] = -1;
+        value[i] = -1;
+    }
+#ifdef __linux__
+    fd[0] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fd[1] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fd[2] = openCounter(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL));
+    fd[3] = openCounter(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB));
+    fd[4] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+    if (!available()) {
+        cerr << "perf counters unavailable, reporting n/a" << endl;
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (int i = 0; i < EVENTS; i++) {
+        if (fd[i] >= 0) close(fd[i]);
+    }
+#endif
+}
+
+bool PerfCounters::available() const
+{
+    for (int i = 0; i < EVENTS; i++) {
+        if (fd[i] >= 0) return true;
+    }
+    return false;
+}
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+    for (int i = 0; i < EVENTS; i++) {
+        if (fd[i] < 0) continue;
+        ioctl(fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounters::stop()
+{
+#ifdef __linux__
+    for (int i = 0; i < EVENTS; i++) {
+        if (fd[i] < 0) continue;
+        ioctl(fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t buf[3];    // value, time enabled, time running
+        if (read(fd[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf) || buf[2] == 0) {
+            value[i] = -1;
+            continue;
+        }
+        value[i] = (double)buf[0] * ((double)buf[1] / buf[2]);
+    }
+#endif
+}
+
+void PerfCounters::report(const string& policy, int csize, long long refs)
+{
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "PerfCounters " << policy
+            << " CacheSize " << csize
+            << " refs " << refs;
+        for (int i = 0; i < EVENTS; i++) {
+            out << " " << eventNames[i] << "PerKRef ";
+            if (value[i] < 0 || refs <= 0) out << "n/a";
+            else out << value[i] * 1000.0 / refs;
+        }
+        out << endl;
+    }
+}
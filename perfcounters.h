@@ -0,0 +1,34 @@
+#ifndef _perfcounters_H
+#define _perfcounters_H
+
+#include <string>
+using namespace std;
+
+/*
+   Hardware counters around a replay loop, read through perf_event_open:
+   cycles, instructions, LLC read misses, dTLB read misses and branch
+   misses, user space only. Counters the kernel refuses (containers,
+   perf_event_paranoid, missing PMU, non-Linux builds) are reported as
+   n/a and the run carries on.
+*/
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    bool available() const;   // at least one counter could be opened
+
+    void start();
+    void stop();
+
+    // per 1000 references
+    void report(const string& policy, int csize, long long refs);
+
+private:
+    static const int EVENTS = 5;
+    int fd[EVENTS];
+    double value[EVENTS];
+};
+
+#endif
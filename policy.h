@@ -0,0 +1,175 @@
+#ifndef _policy_H
+#define _policy_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+// The list, queue or expert an evicted page was taken from. Policies with
+// a single list report SEG_NONE; MQ reports SEG_Q0 + its queue number.
+enum EvictSegment
+{
+    SEG_NONE = 0,
+    SEG_T1, SEG_T2,         // ARC
+    SEG_HIR,                // LIRS, resident HIR pages
+    SEG_LRU, SEG_LFU,       // CACHEUS, LeCaR: the expert that chose the victim
+    SEG_SMALL, SEG_MAIN,    // S3FIFO
+    SEG_WINDOW,             // TinyLFU: window page refused by the admission filter
+    SEG_Q0,                 // MQ queues follow
+    SEG_COUNT = SEG_Q0 + 8
+};
+
+inline const char* segmentName(int segment)
+{
+    static const char* names[SEG_Q0] = {
+        "none", "T1", "T2", "HIR", "LRU", "LFU", "small", "main", "window"
+    };
+    static const char* queues[8] = { "Q0", "Q1", "Q2", "Q3", "Q4", "Q5", "Q6", "Q7" };
+    if (segment >= 0 && segment < SEG_Q0) return names[segment];
+    if (segment >= SEG_Q0 && segment < SEG_COUNT) return queues[segment - SEG_Q0];
+    return "?";
+}
+
+/*
+   Callbacks fired by a policy while it serves references. Simulators that
+   sit beside the cache (write-back, device model, ...) implement this
+   interface so they work with every policy unchanged.
+*/
+class CacheObserver
+{
+public:
+    virtual ~CacheObserver() {}
+
+    // a resident page leaves the cache; dirty if it was written while cached
+    virtual void onEvict(long long int addr, bool dirty) {}
+
+    // the same eviction with the EvictSegment it came from; observers that
+    // do not care about segments only see onEvict
+    virtual void onEvictFrom(long long int addr, bool dirty, int segment) { onEvict(addr, dirty); }
+
+    // fired once per refer(), after any eviction the reference caused
+    virtual void onAccess(long long int addr, bool write, bool hit) {}
+
+    // a trace request starts; its pages follow as refer() calls.
+    // timestamp is in trace units (100ns for MSR), -1 when the trace has none
+    virtual void onRequest(long long int timestamp) {}
+};
+
+// Fan-out so several observers can watch the same policy.
+class ObserverList : public CacheObserver
+{
+public:
+    void add(CacheObserver* o) { obs.push_back(o); }
+    bool empty() const { return obs.empty(); }
+
+    void onEvict(long long int addr, bool dirty) {
+        for (size_t i = 0; i < obs.size(); i++) obs[i]->onEvict(addr, dirty);
+    }
+    void onEvictFrom(long long int addr, bool dirty, int segment) {
+        for (size_t i = 0; i < obs.size(); i++) obs[i]->onEvictFrom(addr, dirty, segment);
+    }
+    void onAccess(long long int addr, bool write, bool hit) {
+        for (size_t i = 0; i < obs.size(); i++) obs[i]->onAccess(addr, write, hit);
+    }
+    void onRequest(long long int timestamp) {
+        for (size_t i = 0; i < obs.size(); i++) obs[i]->onRequest(timestamp);
+    }
+
+private:
+    vector<CacheObserver*> obs;
+};
+
+// Counts references and hits, e.g. to compare two policies on the same stream
+class HitCounter : public CacheObserver
+{
+public:
+    HitCounter() : calls(0), hits(0) {}
+
+    void onAccess(long long int addr, bool write, bool hit) {
+        calls++;
+        if (hit) hits++;
+    }
+    double hitRatio() const { return calls > 0 ? (double)hits / calls : 0.0; }
+
+    long long calls;
+    long long hits;
+};
+
+// Construction options of the policies; defaults are the published settings
+struct PolicyParams
+{
+    bool compactGhosts;      // ARC, CACHEUS: fingerprint ghost lists
+    unsigned seed;           // LeCaR: random expert choice
+    double lirsHirShare;     // LIRS: cache share of resident HIR pages
+    double lirsHistory;      // LIRS: exact non-resident entries in cache sizes, 0 unbounded
+    double cacheusHistory;   // CACHEUS: history size as a share of the cache
+    double cacheusAlpha;     // CACHEUS: weight step per history hit
+    double arcGhostFactor;   // ARC: resident plus ghost entries, in cache sizes
+
+    PolicyParams()
+        : compactGhosts(false), seed(42), lirsHirShare(0.01), lirsHistory(0),
+          cacheusHistory(0.1), cacheusAlpha(0.1), arcGhostFactor(2.0) {}
+};
+
+// Common interface of every replacement policy driven by main.cpp.
+class CachePolicy
+{
+public:
+    CachePolicy() : observer(NULL) {}
+    virtual ~CachePolicy() {}
+
+    virtual void refer(long long int addr, string rw) = 0;
+
+    // print the summary and append it to ExperimentalResult.txt
+    virtual void report() = 0;
+
+    // true if addr is resident, without touching any policy state
+    virtual bool contains(long long int addr) = 0;
+
+    // the page a miss would evict right now, -1 while the cache has room
+    virtual long long int victim() = 0;
+
+    // An MSR request whose 4KB pages are referenced next; tenant is the
+    // dense id of its (device, disk). For front-ends that look at whole
+    // requests, the policies themselves ignore it.
+    virtual void beginRequest(int tenant, long long int offset, int size) {}
+
+    // Bring in a page nobody asked for yet (readahead). Not a reference:
+    // policies that override it place the page without counting a call
+    // or adapting to it; the default inserts it like a read, so its
+    // counters include it. Only called for pages that are not resident.
+    virtual void prefetch(long long int addr) { refer(addr, "Read"); }
+
+    // Take a resident page out without counting or reporting an eviction,
+    // for moving pages between cache tiers. dirty receives its dirty bit.
+    // Only meaningful where canRemove() is true.
+    virtual bool remove(long long int addr, bool& dirty) { return false; }
+    virtual bool canRemove() const { return false; }
+
+    // Change the capacity in place, for partitions that trade pages.
+    // Shrinking evicts (and reports) pages the way a miss would.
+    // Only meaningful where canResize() is true.
+    virtual void resize(int newSize) {}
+    virtual bool canResize() const { return false; }
+
+    // Adaptive state for telemetry time series: telemetryFields() names
+    // the columns, telemetry() fills the current values in the same
+    // order. Counters in it are cumulative. Empty for policies without
+    // such state.
+    virtual void telemetryFields(vector<string>& names) const {}
+    virtual void telemetry(vector<double>& values) const {}
+
+    void setObserver(CacheObserver* o) { observer = o; }
+
+protected:
+    void notifyEvict(long long int addr, bool dirty, int segment = SEG_NONE) {
+        if (observer) observer->onEvictFrom(addr, dirty, segment);
+    }
+    void notifyAccess(long long int addr, bool write, bool hit) {
+        if (observer) observer->onAccess(addr, write, hit);
+    }
+
+    CacheObserver* observer;
+};
+
+#endif
@@ -0,0 +1,241 @@
+#include "readahead.h"
+
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+static const long long PAGE = 4 * 1024;
+static const int MIN_WINDOW = 4;    // pages; the limit never shrinks below it
+
+struct ReadaheadCache::Impl : public CacheObserver
+{
+    ReadaheadCache* owner = nullptr;
+    CachePolicy* mainPolicy = nullptr;
+    CachePolicy* baseline = nullptr;
+    HitCounter baselineHits;
+    string mainName;
+    int capacity = 0;
+    int maxWindow = 0;
+
+    struct Window {
+        long long prevEnd;  // byte after the disk's last request, -1 before the first
+        long long from;     // first byte of the window being consumed
+        long long start;    // first byte of the window read ahead of it
+        int size;           // pages, 0 while readahead is off
+        int limit;          // current cap on size, pages
+    };
+    vector<Window> windows;         // indexed by tenant
+
+    // window waiting for the end of the request that opened it
+    bool pending = false;
+    int pendingTenant = 0;
+    long long pendingStart = 0;
+    int pendingSize = 0;
+
+    // prefetched pages not referenced yet, with the disk they belong to
+    unordered_map<long long, int> unused;
+    bool prefetching = false;
+
+    long long calls = 0;
+    long long hits = 0;
+    long long readHits = 0;
+    long long writeHits = 0;
+    long long evictedDirtyPage = 0;
+    long long windowsIssued = 0;
+    long long prefetched = 0;
+    long long alreadyCached = 0;
+    long long prefetchHits = 0;
+    long long wasted = 0;
+    long long limitShrinks = 0;
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    void onEvictFrom(long long int addr, bool dirty, int segment) {
+        if (dirty) evictedDirtyPage++;
+        auto it = unused.find(addr);
+        if (it != unused.end()) {
+            // read ahead for nothing: the disk gets a smaller window
+            wasted++;
+            Window& w = windows[it->second];
+            if (w.limit > MIN_WINDOW) {
+                w.limit = max(MIN_WINDOW, w.limit / 2);
+                limitShrinks++;
+            }
+            unused.erase(it);
+        }
+        owner->notifyEvict(addr, dirty, segment);
+    }
+
+    // the inserts of prefetch() are not demand references
+    void onAccess(long long int addr, bool write, bool hit) {
+        if (prefetching) return;
+        calls++;
+        if (hit) {
+            hits++;
+            if (write) writeHits++; else readHits++;
+        }
+        if (unused.erase(addr) && hit) prefetchHits++;
+        owner->notifyAccess(addr, write, hit);
+    }
+
+    Window& window(int tenant) {
+        if (tenant >= (int)windows.size()) {
+            Window none = { -1, 0, 0, 0, maxWindow };
+            windows.resize(tenant + 1, none);
+        }
+        return windows[tenant];
+    }
+
+    // get_init_ra_size(): small requests get a larger multiple
+    int initSize(int reqPages, int limit) const {
+        int n = 1;
+        while (n < reqPages) n <<= 1;
+        if (n <= limit / 32) n *= 4;
+        else if (n <= limit / 4) n *= 2;
+        else n = limit;
+        return min(n, limit);
+    }
+
+    // get_next_ra_size()
+    int nextSize(int cur, int limit) const {
+        if (cur < limit / 16) return 4 * cur;
+        if (cur <= limit / 2) return 2 * cur;
+        return limit;
+    }
+
+    void open(int tenant, long long start, int size) {
+        pending = true;
+        pendingTenant = tenant;
+        pendingStart = start;
+        pendingSize = size;
+    }
+
+    void issuePending() {
+        if (!pending) return;
+        pending = false;
+        windowsIssued++;
+        prefetching = true;
+        for (int i = 0; i < pendingSize; i++) {
+            long long addr = pendingStart + i * PAGE;
+            if (mainPolicy->contains(addr)) {
+                alreadyCached++;
+                continue;
+            }
+            prefetched++;
+            unused[addr] = pendingTenant;
+            mainPolicy->prefetch(addr);
+        }
+        prefetching = false;
+    }
+
+    void request(int tenant, long long offset, int size) {
+        Window& w = window(tenant);
+        long long end = offset + size;
+        int reqPages = (int)((size + PAGE - 1) / PAGE);
+        long long windowEnd = w.start + w.size * PAGE;
+        bool inWindow = w.size > 0 && offset >= w.from && offset < windowEnd;
+
+        if (w.size > 0 && offset <= w.start && w.start < end) {
+            // reached the marker: the next window follows the current one
+            w.limit = min(maxWindow, w.limit * 2);
+            w.from = w.start;
+            w.start = windowEnd;
+            w.size = nextSize(w.size, w.limit);
+            open(tenant, w.start, w.size);
+        } else if (!inWindow && offset == w.prevEnd) {
+            // sequential miss outside any window
+            w.from = w.start = end;
+            w.size = initSize(reqPages, w.limit);
+            open(tenant, w.start, w.size);
+        } else if (!inWindow) {
+            w.size = 0;
+        }
+        w.prevEnd = end;
+    }
+};
+
+ReadaheadCache::ReadaheadCache(CachePolicy* mainPolicy, CachePolicy* baseline, const string& mainName,
+                               int capacity, int maxWindowPages)
+{
+    p = new Impl();
+    p->owner = this;
+    p->mainPolicy = mainPolicy;
+    p->baseline = baseline;
+    p->mainName = mainName;
+    p->capacity = capacity;
+    p->maxWindow = max(MIN_WINDOW, maxWindowPages);
+    mainPolicy->setObserver(p);
+    baseline->setObserver(&p->baselineHits);
+}
+
+ReadaheadCache::~ReadaheadCache()
+{
+    delete p->mainPolicy;
+    delete p->baseline;
+    delete p;
+}
+
+void ReadaheadCache::beginRequest(int tenant, long long int offset, int size)
+{
+    // the window of the previous request is read once that request is done
+    p->issuePending();
+    p->request(tenant, offset, size);
+}
+
+void ReadaheadCache::refer(long long int addr, string rw)
+{
+    p->baseline->refer(addr, rw);
+    p->mainPolicy->refer(addr, rw);
+}
+
+bool ReadaheadCache::contains(long long int addr)
+{
+    return p->mainPolicy->contains(addr);
+}
+
+long long int ReadaheadCache::victim()
+{
+    return p->mainPolicy->victim();
+}
+
+void ReadaheadCache::report()
+{
+    long long misses = p->calls - p->hits;
+    long long baselineMisses = p->baselineHits.calls - p->baselineHits.hits;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "Readahead-" << p->mainName
+            << " CacheSize " << p->capacity
+            << " maxWindow " << p->maxWindow
+            << " calls " << p->calls
+            << " hits " << p->hits
+            << " hitRatio " << (p->calls ? (double)p->hits / p->calls : 0.0)
+            << " readHits " << p->readHits
+            << " writeHits " << p->writeHits
+            << " evictedDirtyPage " << p->evictedDirtyPage
+            << " windows " << p->windowsIssued
+            << " prefetched " << p->prefetched
+            << " alreadyCached " << p->alreadyCached
+            << " prefetchHits " << p->prefetchHits
+            << " wasted " << p->wasted
+            << " unusedAtEnd " << p->unused.size()
+            << " accuracy " << (p->prefetched ? (double)p->prefetchHits / p->prefetched : 0.0)
+            << " limitShrinks " << p->limitShrinks
+            << " demandMisses " << misses
+            << " baselineMisses " << baselineMisses
+            << " missChange " << misses - baselineMisses
+            << " backendReads " << misses + p->prefetched
+            << " baselineHitRatio " << p->baselineHits.hitRatio()
+            << endl;
+    }
+}
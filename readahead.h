@@ -0,0 +1,40 @@
+#ifndef _readahead_H
+#define _readahead_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   Readahead in front of any policy, after Linux's ondemand readahead.
+   Every disk keeps one window. A request that starts where the previous
+   one of the disk ended opens a window right after it, sized from the
+   request; a request that reaches the window's first page (the async
+   marker) opens the next window behind it, up to four times larger and
+   at most the limit. Any other request outside the window stops
+   readahead until the disk reads sequentially again. Windows are issued
+   when the next request begins, through the policy's prefetch() hook.
+   A prefetched page evicted before it was used halves the disk's limit;
+   reaching a marker doubles it back towards the maximum. A plain copy of
+   the policy without readahead gives the demand misses to compare with.
+*/
+class ReadaheadCache : public CachePolicy
+{
+public:
+    // takes ownership of both policies, which should have the same size
+    ReadaheadCache(CachePolicy* mainPolicy, CachePolicy* baseline, const string& mainName,
+                   int capacity, int maxWindowPages);
+    ~ReadaheadCache();
+
+    void beginRequest(int tenant, long long int offset, int size);
+    void refer(long long int addr, string rw);
+    void report();
+    bool contains(long long int addr);
+    long long int victim();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -1,7 +1,7 @@
 #!/bin/bash 
 
 #mds_1.csv
-for policy in LRU LFU LIRS ARC CACHEUS
+for policy in LRU LFU LIRS ARC CACHEUS S3FIFO SIEVE MQ LeCaR OPT
 do
         for csize in 703 3514 7028 35142 70284 140568 281137 562274 632558
         do
@@ -10,7 +10,7 @@ do
 done
 
 #prn_0.csv
-for policy in LRU LFU LIRS ARC CACHEUS
+for policy in LRU LFU LIRS ARC CACHEUS S3FIFO SIEVE MQ LeCaR OPT
 do
         for csize in 703 3514 7028 35142 70284 140568 281137 562274 632558
         do
@@ -19,7 +19,7 @@ do
 done
 
 #hm_1.csv
-for policy in LRU LFU LIRS ARC CACHEUS
+for policy in LRU LFU LIRS ARC CACHEUS S3FIFO SIEVE MQ LeCaR OPT
 do
         for csize in 703 3514 7028 35142 70284 140568 281137 562274 632558
         do
@@ -28,10 +28,198 @@ do
 done
 
 #mds_0.csv
-for policy in LRU LFU LIRS ARC CACHEUS
+for policy in LRU LFU LIRS ARC CACHEUS S3FIFO SIEVE MQ LeCaR OPT
 do
         for csize in 703 3514 7028 35142 70284 140568 281137 562274 632558
         do
                 ./cache -m $policy -f 2 -i mds_0.csv -s $csize
         done
-done
\ No newline at end of file
+done
+
+#W-TinyLFU admission in front of each policy
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in LRU LFU LIRS ARC CACHEUS
+        do
+                for csize in 703 3514 7028 35142 70284 140568 281137 562274 632558
+                do
+                        ./cache -m $policy -f 2 -i $trace -s $csize -a TinyLFU
+                done
+        done
+done
+
+
+#compact ghost lists vs exact ghosts (ARC, CACHEUS)
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in ARC CACHEUS
+        do
+                for csize in 703 3514 7028 35142 70284 140568 281137 562274 632558
+                do
+                        ./cache -m $policy -f 2 -i $trace -s $csize -g compare
+                done
+        done
+done
+
+
+#policy throughput (refs/sec) and hardware counters with the trace preloaded in memory
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in LRU LFU LIRS ARC CACHEUS S3FIFO SIEVE
+        do
+                for csize in 703 7028 70284 632558
+                do
+                        ./cache -m $policy -f 2 -i $trace -s $csize -t -p
+                done
+        done
+done
+
+
+#learning policies at small cache sizes (0.01% - 1% of the sweep range)
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in CACHEUS LeCaR
+        do
+                for csize in 70 140 351 703 1406 3514 7028
+                do
+                        ./cache -m $policy -f 2 -i $trace -s $csize -r 42
+                done
+        done
+done
+
+
+#trace characterization: footprint, mix, sizes, skew, reuse times
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        ./cache -m analyze -f 2 -i $trace
+done
+
+
+#two-tier DRAM over PMEM: DRAM is a tenth of the PMEM tier
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in LRU LFU ARC CACHEUS SIEVE MQ
+        do
+                for csize in 7028 35142 70284 140568 281137 562274
+                do
+                        for placement in exclusive inclusive exclusive,2 inclusive,2
+                        do
+                                ./cache -m $policy -f 2 -i $trace -s $csize -T $((csize / 10)),$placement
+                        done
+                done
+        done
+done
+
+
+#per-trace parameter tuning by successive halving, sizes share one sweep per policy
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        ./cache -m LIRS -f 2 -i $trace -s 7028,35142,70284,140568 -u hirShare=0.005:0.3:8
+        ./cache -m CACHEUS -f 2 -i $trace -s 7028,35142,70284,140568 -u historyFraction=0.05:0.5:4,alpha=0.05:0.3:4
+        ./cache -m ARC -f 2 -i $trace -s 7028,35142,70284,140568 -u ghostFactor=1:4:7
+done
+
+
+#per-reference event logs, summarized by the list or expert each eviction came from
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in ARC LIRS CACHEUS LeCaR S3FIFO
+        do
+                ./cache -m $policy -f 2 -i $trace -s 35142 -l events_${policy}_${trace%.csv}.bin
+                ./cache -m dump -i events_${policy}_${trace%.csv}.bin > /dev/null
+        done
+done
+
+
+#1GB LBA-region heatmaps per hour of trace time
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in LRU ARC CACHEUS
+        do
+                ./cache -m $policy -f 2 -i $trace -s 35142 -H 1024,3600
+        done
+done
+
+
+#compulsory / capacity / policy misses against MIN of the same size
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        ./cache -C LRU,ARC,LIRS,CACHEUS,S3FIFO,LeCaR -f 2 -i $trace -s 7028,35142,70284,140568,281137
+done
+
+
+#adaptation telemetry of ARC, LIRS and CACHEUS every 100K references
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in ARC LIRS CACHEUS
+        do
+                ./cache -m $policy -f 2 -i $trace -s 35142 -S 100000,Telemetry_${policy}_${trace%.csv}.csv
+        done
+done
+
+
+#UCP partitioning between the volumes of a merged trace, against one shared cache
+sort -t, -k1,1n -m hm_1.csv mds_1.csv prn_0.csv > merged_hm_mds_prn.csv
+for policy in LRU ARC LIRS CACHEUS
+do
+        for size in 7028 35142 70284 140568
+        do
+                ./cache -m $policy -f 2 -i merged_hm_mds_prn.csv -s $size -P 0
+        done
+done
+
+
+#sequential stream bypass against the plain policy
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in LRU ARC CACHEUS
+        do
+                for threshold in 128 512 2048
+                do
+                        ./cache -m $policy -f 2 -i $trace -s 35142 -b $threshold
+                done
+        done
+done
+
+
+#ondemand readahead: prefetch accuracy and demand misses against no readahead
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for policy in LRU ARC
+        do
+                for window in 128 512
+                do
+                        ./cache -m $policy -f 2 -i $trace -s 35142 -R $window
+                done
+        done
+done
+
+
+#open-loop replay: raise the arrival rate until response times take off
+for policy in LRU ARC CACHEUS
+do
+        for speedup in 1000 5000 20000 100000
+        do
+                ./cache -m $policy -f 2 -i hm_1.csv -s 35142 -O $speedup,16,200
+        done
+done
+
+
+#LIRS with its non-resident history bounded to 0.5, 1 and 3 cache sizes
+for trace in mds_1.csv prn_0.csv hm_1.csv mds_0.csv
+do
+        for bound in 0.5 1 3
+        do
+                ./cache -m LIRS -f 2 -i $trace -s 35142 -n $bound
+        done
+done
+
+
+#compressed traces straight from the decompressor, no temporary files
+for trace in mds_1 prn_0 hm_1 mds_0
+do
+        if [ -f $trace.csv.zst ]
+        then
+                zstdcat $trace.csv.zst | ./cache -m ARC -f 2 -i - -s 35142
+        fi
+done
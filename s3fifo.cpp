@@ -0,0 +1,227 @@
+#include "s3fifo.h"
+
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+// Fixed-size FIFO over a power-of-two array: push at the tail, pop at the
+// head. Only the two indices move, nothing is ever relinked.
+class KeyRing
+{
+public:
+    void init(size_t capacity)
+    {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        buf.assign(n, 0);
+        mask = n - 1;
+        head = tail = 0;
+    }
+
+    size_t size() const { return tail - head; }
+    bool empty() const { return head == tail; }
+    long long front() const { return buf[head & mask]; }
+
+    void push(long long k) { buf[tail++ & mask] = k; }
+    long long pop() { return buf[head++ & mask]; }
+
+private:
+    vector<long long> buf;
+    size_t mask = 0;
+    size_t head = 0;
+    size_t tail = 0;
+};
+
+struct S3FIFOCache::Impl
+{
+    S3FIFOCache* owner = nullptr;
+
+    int c = 0;
+    int sCap = 0;     // target size of the small queue
+    int gCap = 0;     // ghost entries, as many as the main queue holds
+
+    long long calls = 0;
+    long long hits = 0;
+    long long readHits = 0;
+    long long writeHits = 0;
+    long long evictedDirtyPage = 0;
+    long long promoted = 0;     // small -> main
+    long long ghostHits = 0;    // misses that went straight to main
+
+    enum { SMALL = 0, MAIN = 1 };
+    struct Entry {
+        unsigned char freq;     // 0..3
+        unsigned char queue;
+        bool dirty;
+    };
+    unordered_map<long long, Entry> table;
+
+    KeyRing S, M;
+
+    // Ghost FIFO of keys. The map holds the sequence number of the live
+    // copy of each key, so a slot that falls off the ring only forgets the
+    // key if it was not re-added since (or taken back into main)
+    KeyRing G;
+    unordered_map<long long, long long> ghost;
+    long long gSeq = 0;
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    void addGhost(long long k) {
+        if ((int)G.size() >= gCap) {
+            long long oldSeq = gSeq - (long long)G.size();
+            auto it = ghost.find(G.pop());
+            if (it != ghost.end() && it->second == oldSeq) ghost.erase(it);
+        }
+        G.push(k);
+        ghost[k] = gSeq++;
+    }
+
+    void drop(long long k, const Entry& e) {
+        if (e.dirty) evictedDirtyPage++;
+        owner->notifyEvict(k, e.dirty, e.queue == SMALL ? SEG_SMALL : SEG_MAIN);
+        table.erase(k);
+    }
+
+    // Small queue: pages hit at least twice move to main, the rest leave
+    // (their key goes to the ghost queue). Returns true once a page left.
+    bool evictS() {
+        while (!S.empty()) {
+            long long t = S.pop();
+            Entry& e = table[t];
+            if (e.freq > 1) {
+                e.freq = 0;
+                e.queue = MAIN;
+                M.push(t);
+                promoted++;
+            } else {
+                drop(t, e);
+                addGhost(t);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Main queue: CLOCK-like, pages with a non-zero counter get another lap
+    void evictM() {
+        while (!M.empty()) {
+            long long t = M.pop();
+            Entry& e = table[t];
+            if (e.freq > 0) {
+                e.freq--;
+                M.push(t);
+            } else {
+                drop(t, e);
+                return;
+            }
+        }
+    }
+
+    void evict() {
+        if ((int)S.size() >= sCap || M.empty()) {
+            if (evictS()) return;
+        }
+        evictM();
+    }
+
+    bool access(long long k, const string& rw) {
+        calls++;
+        bool write = isWrite(rw);
+
+        auto it = table.find(k);
+        if (it != table.end()) {
+            hits++;
+            if (write) writeHits++; else readHits++;
+            Entry& e = it->second;
+            if (e.freq < 3) e.freq++;
+            if (write) e.dirty = true;
+            return true;
+        }
+
+        if (c <= 0) return false;
+        while ((int)table.size() >= c) evict();
+
+        Entry e = { 0, SMALL, write };
+        auto g = ghost.find(k);
+        if (g != ghost.end()) {
+            ghost.erase(g);
+            ghostHits++;
+            e.queue = MAIN;
+            M.push(k);
+        } else {
+            S.push(k);
+        }
+        table[k] = e;
+        return false;
+    }
+};
+
+S3FIFOCache::S3FIFOCache(int size)
+{
+    p = new Impl();
+    p->owner = this;
+    p->c = max(0, size);
+    p->sCap = max(1, p->c / 10);
+    p->gCap = max(1, p->c - p->sCap);
+
+    // either queue may briefly hold the whole cache
+    p->S.init(p->c + 1);
+    p->M.init(p->c + 1);
+    p->G.init(p->gCap + 1);
+    p->table.reserve(p->c + 1);
+    p->ghost.reserve(p->gCap + 1);
+}
+
+S3FIFOCache::~S3FIFOCache()
+{
+    delete p;
+}
+
+void S3FIFOCache::refer(long long int addr, string rw)
+{
+    bool hit = p->access(addr, rw);
+    notifyAccess(addr, Impl::isWrite(rw), hit);
+}
+
+bool S3FIFOCache::contains(long long int addr)
+{
+    return p->table.find(addr) != p->table.end();
+}
+
+long long int S3FIFOCache::victim()
+{
+    // oldest page of the queue the next eviction starts from; pages that
+    // earn another lap there may be skipped in practice
+    if ((int)p->table.size() < p->c) return -1;
+    if (((int)p->S.size() >= p->sCap || p->M.empty()) && !p->S.empty()) return p->S.front();
+    return p->M.empty() ? -1 : p->M.front();
+}
+
+void S3FIFOCache::cacheHitsSummary()
+{
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "S3FIFO CacheSize " << p->c
+            << " calls " << p->calls
+            << " hits " << p->hits
+            << " hitRatio " << (p->calls ? (double)p->hits / p->calls : 0.0)
+            << " readHits " << p->readHits
+            << " readHitRatio " << (p->calls ? (double)p->readHits / p->calls : 0.0)
+            << " writeHits " << p->writeHits
+            << " writeHitRatio " << (p->calls ? (double)p->writeHits / p->calls : 0.0)
+            << " evictedDirtyPage " << p->evictedDirtyPage
+            << " promoted " << p->promoted
+            << " ghostHits " << p->ghostHits
+            << endl;
+    }
+}
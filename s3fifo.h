@@ -0,0 +1,32 @@
+#ifndef _s3fifo_H
+#define _s3fifo_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   S3-FIFO: a small probationary FIFO (10% of the cache), a main FIFO with
+   a 2-bit access counter per page, and a ghost FIFO of keys recently
+   evicted from the small queue. All three queues are ring buffers, so a
+   hit only bumps the page's counter and never reorders anything.
+*/
+class S3FIFOCache : public CachePolicy
+{
+public:
+    S3FIFOCache(int);
+    ~S3FIFOCache();
+
+    void refer(long long int addr, string rw);
+
+    void cacheHitsSummary();
+    void report() { cacheHitsSummary(); }
+    bool contains(long long int addr);
+    long long int victim();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
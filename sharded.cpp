@@ -0,0 +1,100 @@
+#include "sharded.h"
+
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include "hash.h"
+
+using namespace std;
+
+// Reports whether the last reference hit; read under the shard's lock
+class LastAccess : public CacheObserver
+{
+public:
+    LastAccess() : hit(false) {}
+    void onAccess(long long int addr, bool write, bool h) { hit = h; }
+    bool hit;
+};
+
+struct ShardedCache::Impl
+{
+    struct Shard {
+        mutex lock;
+        CachePolicy* cache = nullptr;
+        LastAccess last;
+        long long calls = 0;
+        long long hits = 0;
+    };
+    vector<Shard*> shards;
+    bool ok = true;
+
+    Shard& of(long long addr) {
+        return *shards[mix64((uint64_t)addr) % shards.size()];
+    }
+};
+
+ShardedCache::ShardedCache(PolicyMaker make, const PolicyParams& params, const string& policy,
+                           int csize, int shards)
+{
+    p = new Impl();
+    int n = max(1, min(shards, max(1, csize)));
+    for (int i = 0; i < n; i++) {
+        Impl::Shard* s = new Impl::Shard();
+        // the first csize % n shards take one page more
+        int size = csize / n + (i < csize % n ? 1 : 0);
+        s->cache = make(policy, size, params);
+        if (!s->cache) p->ok = false;
+        else s->cache->setObserver(&s->last);
+        p->shards.push_back(s);
+    }
+}
+
+ShardedCache::~ShardedCache()
+{
+    for (size_t i = 0; i < p->shards.size(); i++) {
+        delete p->shards[i]->cache;
+        delete p->shards[i];
+    }
+    delete p;
+}
+
+bool ShardedCache::ok() const
+{
+    return p->ok;
+}
+
+bool ShardedCache::refer(long long addr, const string& rw)
+{
+    Impl::Shard& s = p->of(addr);
+    lock_guard<mutex> hold(s.lock);
+    s.last.hit = false;
+    s.cache->refer(addr, rw);
+    s.calls++;
+    if (s.last.hit) s.hits++;
+    return s.last.hit;
+}
+
+int ShardedCache::shards() const
+{
+    return (int)p->shards.size();
+}
+
+long long ShardedCache::calls() const
+{
+    long long n = 0;
+    for (size_t i = 0; i < p->shards.size(); i++) {
+        lock_guard<mutex> hold(p->shards[i]->lock);
+        n += p->shards[i]->calls;
+    }
+    return n;
+}
+
+long long ShardedCache::hits() const
+{
+    long long n = 0;
+    for (size_t i = 0; i < p->shards.size(); i++) {
+        lock_guard<mutex> hold(p->shards[i]->lock);
+        n += p->shards[i]->hits;
+    }
+    return n;
+}
@@ -0,0 +1,37 @@
+#ifndef _sharded_H
+#define _sharded_H
+
+#include <string>
+#include "policy.h"
+#include "tune.h"
+using namespace std;
+
+/*
+   A thread-safe cache for concurrent clients: the pages are spread over
+   shards by hash, each shard an instance of the policy with its share of
+   the capacity behind its own mutex. Threads only contend when they
+   touch the same shard, and each shard's replacement sees the usual
+   single-threaded reference stream of its pages.
+*/
+class ShardedCache
+{
+public:
+    ShardedCache(PolicyMaker make, const PolicyParams& params, const string& policy,
+                 int csize, int shards);
+    ~ShardedCache();
+
+    bool ok() const;
+
+    // reference one page, true on a hit; safe to call from any thread
+    bool refer(long long addr, const string& rw);
+
+    int shards() const;
+    long long calls() const;
+    long long hits() const;
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,177 @@
+#include "sieve.h"
+
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+struct SIEVECache::Impl
+{
+    SIEVECache* owner = nullptr;
+
+    int c = 0;
+
+    long long calls = 0;
+    long long hits = 0;
+    long long readHits = 0;
+    long long writeHits = 0;
+    long long evictedDirtyPage = 0;
+    long long handSteps = 0;    // entries the hand passed over
+
+    // Queue nodes live in one array and link by index; -1 is null.
+    // head is the newest page, tail the oldest.
+    struct Node {
+        long long key;
+        int prev;       // towards head
+        int next;       // towards tail
+        bool visited;
+        bool dirty;
+    };
+    vector<Node> nodes;
+    vector<int> freeSlots;
+    int head = -1;
+    int tail = -1;
+    int hand = -1;
+
+    unordered_map<long long, int> index;
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    void pushHead(int i) {
+        nodes[i].prev = -1;
+        nodes[i].next = head;
+        if (head != -1) nodes[head].prev = i;
+        head = i;
+        if (tail == -1) tail = i;
+    }
+
+    void unlink(int i) {
+        Node& n = nodes[i];
+        if (n.prev != -1) nodes[n.prev].next = n.next; else head = n.next;
+        if (n.next != -1) nodes[n.next].prev = n.prev; else tail = n.prev;
+    }
+
+    void evict() {
+        int o = hand != -1 ? hand : tail;
+        while (nodes[o].visited) {
+            nodes[o].visited = false;
+            o = nodes[o].prev != -1 ? nodes[o].prev : tail;
+            handSteps++;
+        }
+        hand = nodes[o].prev;
+
+        Node& n = nodes[o];
+        if (n.dirty) evictedDirtyPage++;
+        owner->notifyEvict(n.key, n.dirty);
+        index.erase(n.key);
+        unlink(o);
+        freeSlots.push_back(o);
+    }
+
+    bool access(long long k, const string& rw) {
+        calls++;
+        bool write = isWrite(rw);
+
+        auto it = index.find(k);
+        if (it != index.end()) {
+            hits++;
+            if (write) writeHits++; else readHits++;
+            Node& n = nodes[it->second];
+            n.visited = true;
+            if (write) n.dirty = true;
+            return true;
+        }
+
+        if (c <= 0) return false;
+        if ((int)index.size() >= c) evict();
+
+        int i = freeSlots.back();
+        freeSlots.pop_back();
+        nodes[i].key = k;
+        nodes[i].visited = false;
+        nodes[i].dirty = write;
+        pushHead(i);
+        index[k] = i;
+        return false;
+    }
+};
+
+SIEVECache::SIEVECache(int size)
+{
+    p = new Impl();
+    p->owner = this;
+    p->c = max(0, size);
+    p->nodes.resize(p->c);
+    p->freeSlots.reserve(p->c);
+    for (int i = p->c - 1; i >= 0; i--) p->freeSlots.push_back(i);
+    p->index.reserve(p->c + 1);
+}
+
+SIEVECache::~SIEVECache()
+{
+    delete p;
+}
+
+void SIEVECache::refer(long long int addr, string rw)
+{
+    bool hit = p->access(addr, rw);
+    notifyAccess(addr, Impl::isWrite(rw), hit);
+}
+
+bool SIEVECache::contains(long long int addr)
+{
+    return p->index.find(addr) != p->index.end();
+}
+
+long long int SIEVECache::victim()
+{
+    // first unvisited page from the hand on; if every page is visited the
+    // hand clears them all and comes back to where it started
+    if ((int)p->index.size() < p->c || p->c <= 0) return -1;
+    int start = p->hand != -1 ? p->hand : p->tail;
+    int o = start;
+    do {
+        if (!p->nodes[o].visited) return p->nodes[o].key;
+        o = p->nodes[o].prev != -1 ? p->nodes[o].prev : p->tail;
+    } while (o != start);
+    return p->nodes[start].key;
+}
+
+bool SIEVECache::remove(long long int addr, bool& dirty)
+{
+    auto it = p->index.find(addr);
+    if (it == p->index.end()) return false;
+    int i = it->second;
+    dirty = p->nodes[i].dirty;
+    if (p->hand == i) p->hand = p->nodes[i].prev;
+    p->unlink(i);
+    p->freeSlots.push_back(i);
+    p->index.erase(it);
+    return true;
+}
+
+void SIEVECache::cacheHitsSummary()
+{
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "SIEVE CacheSize " << p->c
+            << " calls " << p->calls
+            << " hits " << p->hits
+            << " hitRatio " << (p->calls ? (double)p->hits / p->calls : 0.0)
+            << " readHits " << p->readHits
+            << " readHitRatio " << (p->calls ? (double)p->readHits / p->calls : 0.0)
+            << " writeHits " << p->writeHits
+            << " writeHitRatio " << (p->calls ? (double)p->writeHits / p->calls : 0.0)
+            << " evictedDirtyPage " << p->evictedDirtyPage
+            << " handSteps " << p->handSteps
+            << endl;
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef _sieve_H
+#define _sieve_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   SIEVE: one FIFO queue and a hand that moves from the oldest entry
+   towards the newest. A hit only sets the page's visited bit; the hand
+   clears visited bits as it passes and evicts the first unvisited page.
+   New pages go to the head and are never moved afterwards.
+*/
+class SIEVECache : public CachePolicy
+{
+public:
+    SIEVECache(int);
+    ~SIEVECache();
+
+    void refer(long long int addr, string rw);
+
+    void cacheHitsSummary();
+    void report() { cacheHitsSummary(); }
+    bool contains(long long int addr);
+    long long int victim();
+    bool remove(long long int addr, bool& dirty);
+    bool canRemove() const { return true; }
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "streambypass.h"
+
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+// a request this far past the end of a stream still continues it, so
+// small skips inside a scan do not restart the count
+static const long long MAX_GAP = 64 * 1024;
+
+struct StreamBypassCache::Impl : public CacheObserver
+{
+    StreamBypassCache* owner = nullptr;
+    CachePolicy* mainPolicy = nullptr;
+    CachePolicy* baseline = nullptr;
+    HitCounter baselineHits;
+    string mainName;
+    int capacity = 0;
+    long long threshold = 0;
+    int streamsPerDisk = 0;
+
+    struct Stream {
+        long long next;     // offset the next request of the stream would start at, -1 if free
+        long long bytes;    // covered so far
+        long long lastUse;
+    };
+    vector<vector<Stream> > streams;   // indexed by tenant
+    long long requests = 0;
+    bool bypassing = false;
+
+    long long calls = 0;
+    long long hits = 0;
+    long long readHits = 0;
+    long long writeHits = 0;
+    long long evictedDirtyPage = 0;
+    long long bypassed = 0;             // page misses kept out of the cache
+    long long bypassedRequests = 0;
+    long long sequentialStreams = 0;    // streams that reached the threshold
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    // hits, misses and evictions of the main policy are the cache's own
+    void onEvictFrom(long long int addr, bool dirty, int segment) {
+        if (dirty) evictedDirtyPage++;
+        owner->notifyEvict(addr, dirty, segment);
+    }
+    void onAccess(long long int addr, bool write, bool hit) {
+        calls++;
+        if (hit) {
+            hits++;
+            if (write) writeHits++; else readHits++;
+        }
+        owner->notifyAccess(addr, write, hit);
+    }
+
+    // Extends the stream the request continues, or starts a new one;
+    // true if the request belongs to a sequential stream
+    bool sequential(int tenant, long long offset, int size) {
+        if (tenant >= (int)streams.size()) {
+            Stream none = { -1, 0, 0 };
+            streams.resize(tenant + 1, vector<Stream>(streamsPerDisk, none));
+        }
+        vector<Stream>& table = streams[tenant];
+        requests++;
+        Stream* s = NULL;
+        Stream* oldest = &table[0];
+        for (size_t i = 0; i < table.size(); i++) {
+            Stream& c = table[i];
+            if (c.next >= 0 && offset >= c.next && offset - c.next <= MAX_GAP) {
+                s = &c;
+                break;
+            }
+            if (c.lastUse < oldest->lastUse) oldest = &c;
+        }
+        if (!s) {
+            s = oldest;
+            s->bytes = 0;
+        }
+        bool was = s->bytes >= threshold;
+        s->bytes += size;
+        s->next = offset + size;
+        s->lastUse = requests;
+        if (!was && s->bytes >= threshold) sequentialStreams++;
+        return s->bytes >= threshold;
+    }
+};
+
+StreamBypassCache::StreamBypassCache(CachePolicy* mainPolicy, CachePolicy* baseline, const string& mainName,
+                                     int capacity, long long thresholdBytes, int streamsPerDisk)
+{
+    p = new Impl();
+    p->owner = this;
+    p->mainPolicy = mainPolicy;
+    p->baseline = baseline;
+    p->mainName = mainName;
+    p->capacity = capacity;
+    p->threshold = max(1LL, thresholdBytes);
+    p->streamsPerDisk = max(1, streamsPerDisk);
+    mainPolicy->setObserver(p);
+    baseline->setObserver(&p->baselineHits);
+}
+
+StreamBypassCache::~StreamBypassCache()
+{
+    delete p->mainPolicy;
+    delete p->baseline;
+    delete p;
+}
+
+void StreamBypassCache::beginRequest(int tenant, long long int offset, int size)
+{
+    p->bypassing = p->sequential(tenant, offset, size);
+    if (p->bypassing) p->bypassedRequests++;
+}
+
+void StreamBypassCache::refer(long long int addr, string rw)
+{
+    p->baseline->refer(addr, rw);
+    if (p->bypassing && !p->mainPolicy->contains(addr)) {
+        p->bypassed++;
+        p->calls++;
+        notifyAccess(addr, Impl::isWrite(rw), false);
+        return;
+    }
+    p->mainPolicy->refer(addr, rw);
+}
+
+bool StreamBypassCache::contains(long long int addr)
+{
+    return p->mainPolicy->contains(addr);
+}
+
+long long int StreamBypassCache::victim()
+{
+    return p->mainPolicy->victim();
+}
+
+void StreamBypassCache::report()
+{
+    double hitRatio = p->calls ? (double)p->hits / p->calls : 0.0;
+    double baselineRatio = p->baselineHits.hitRatio();
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "StreamBypass-" << p->mainName
+            << " CacheSize " << p->capacity
+            << " thresholdKB " << p->threshold / 1024
+            << " calls " << p->calls
+            << " hits " << p->hits
+            << " hitRatio " << hitRatio
+            << " readHits " << p->readHits
+            << " writeHits " << p->writeHits
+            << " evictedDirtyPage " << p->evictedDirtyPage
+            << " bypassed " << p->bypassed
+            << " bypassedRequests " << p->bypassedRequests
+            << " sequentialStreams " << p->sequentialStreams
+            << " baselineHitRatio " << baselineRatio
+            << " hitRatioChange " << hitRatio - baselineRatio
+            << endl;
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef _streambypass_H
+#define _streambypass_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   Sequential stream detection in front of any policy. Every disk has a
+   small table of active streams: a request that starts where a stream
+   ended (or a little past it) extends that stream, any other request
+   starts a new one in place of the least recently used. Once a stream
+   has covered threshold bytes, the misses of its pages bypass the cache
+   instead of pushing out the working set; pages that are already cached
+   are still hits. A plain copy of the policy sees the same references,
+   so the report shows what the bypass gained or lost.
+*/
+class StreamBypassCache : public CachePolicy
+{
+public:
+    // takes ownership of both policies, which should have the same size
+    StreamBypassCache(CachePolicy* mainPolicy, CachePolicy* baseline, const string& mainName,
+                      int capacity, long long thresholdBytes, int streamsPerDisk);
+    ~StreamBypassCache();
+
+    void beginRequest(int tenant, long long int offset, int size);
+    void refer(long long int addr, string rw);
+    void report();
+    bool contains(long long int addr);
+    long long int victim();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#include "telemetry.h"
+
+using namespace std;
+
+TelemetrySampler::TelemetrySampler(CachePolicy* policy, long long every, const string& path)
+    : policy(policy), every(every > 0 ? every : 1), out(fopen(path.c_str(), "w")),
+      refs(0), hits(0), intervalRefs(0), intervalHits(0), rows(0)
+{
+    if (!out) return;
+    vector<string> names;
+    policy->telemetryFields(names);
+    fprintf(out, "refs,hitRatio,intervalHitRatio");
+    for (size_t i = 0; i < names.size(); i++) fprintf(out, ",%s", names[i].c_str());
+    fprintf(out, "\n");
+}
+
+TelemetrySampler::~TelemetrySampler()
+{
+    if (out) fclose(out);
+}
+
+void TelemetrySampler::onAccess(long long int addr, bool write, bool hit)
+{
+    intervalRefs++;
+    if (hit) intervalHits++;
+    if (intervalRefs == every) sample();
+}
+
+void TelemetrySampler::sample()
+{
+    if (!out) return;
+    refs += intervalRefs;
+    hits += intervalHits;
+    policy->telemetry(values);
+    fprintf(out, "%lld,%.6f,%.6f", refs, refs ? (double)hits / refs : 0.0,
+            intervalRefs ? (double)intervalHits / intervalRefs : 0.0);
+    for (size_t i = 0; i < values.size(); i++) fprintf(out, ",%.10g", values[i]);
+    fprintf(out, "\n");
+    intervalRefs = intervalHits = 0;
+    rows++;
+}
+
+void TelemetrySampler::finish()
+{
+    if (intervalRefs > 0) sample();
+    if (out) fclose(out);
+    out = NULL;
+}
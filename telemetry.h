@@ -0,0 +1,41 @@
+#ifndef _telemetry_H
+#define _telemetry_H
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include "policy.h"
+using namespace std;
+
+/*
+   Time series of a policy's adaptive state. Every `every` references
+   the policy's telemetry() record is written as a CSV row, together with
+   the reference count and the hit ratio of the interval. Between samples
+   the cost is one counter and one compare per reference.
+*/
+class TelemetrySampler : public CacheObserver
+{
+public:
+    TelemetrySampler(CachePolicy* policy, long long every, const string& path);
+    ~TelemetrySampler();
+
+    bool ok() const { return out != NULL; }
+
+    void onAccess(long long int addr, bool write, bool hit);
+
+    // last partial interval; closes the file
+    void finish();
+
+    long long samples() const { return rows; }
+
+private:
+    CachePolicy* policy;
+    long long every;
+    FILE* out;
+    long long refs, hits, intervalRefs, intervalHits, rows;
+    vector<double> values;
+
+    void sample();
+};
+
+#endif
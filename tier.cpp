@@ -0,0 +1,222 @@
+#include "tier.h"
+
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+// Collects a tier's evictions during refer() so they are handled after it
+// returns, never from inside the policy
+struct EvictionLog : public CacheObserver
+{
+    vector<pair<long long, bool> > evicted;
+
+    void onEvict(long long int addr, bool dirty) {
+        evicted.push_back(make_pair(addr, dirty));
+    }
+};
+
+struct TieredCache::Impl
+{
+    TieredCache* owner = nullptr;
+    CachePolicy* upper = nullptr;
+    CachePolicy* lower = nullptr;
+    string policy;
+    int upperSize = 0;
+    int lowerSize = 0;
+    bool inclusive = false;
+    int promoteAfter = 1;
+    TierCosts costs;
+
+    EvictionLog upperLog, lowerLog;
+
+    // accesses so far to pages waiting in the lower tier for promotion
+    unordered_map<long long, int> lowerAccesses;
+
+    long long calls = 0;
+    long long upperHits = 0;
+    long long lowerHits = 0;
+    long long misses = 0;
+    long long promotions = 0;
+    long long demotions = 0;
+    long long dirtyDemotions = 0;
+    long long backInvalidations = 0;
+    long long evictedDirtyPage = 0;
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    static const string& rwOf(bool write) {
+        static const string r = "Read", w = "Write";
+        return write ? w : r;
+    }
+
+    // counts a lower-tier access; true when the page has earned promotion
+    bool promotable(long long k) {
+        if (promoteAfter <= 1) return true;
+        int& n = lowerAccesses[k];
+        if (++n < promoteAfter) return false;
+        lowerAccesses.erase(k);
+        return true;
+    }
+
+    // Pages leaving the upper tier go down, pages leaving the lower tier
+    // leave the hierarchy (and, inclusive, take the upper copy with them)
+    void drain() {
+        for (size_t i = 0; i < upperLog.evicted.size(); i++) {
+            long long v = upperLog.evicted[i].first;
+            bool dirty = upperLog.evicted[i].second;
+            if (inclusive) {
+                // the lower copy is still there; only dirty data moves
+                if (!dirty) continue;
+                lower->refer(v, rwOf(true));
+            } else {
+                lower->refer(v, rwOf(dirty));
+            }
+            demotions++;
+            if (dirty) dirtyDemotions++;
+        }
+        upperLog.evicted.clear();
+
+        for (size_t i = 0; i < lowerLog.evicted.size(); i++) {
+            long long w = lowerLog.evicted[i].first;
+            bool dirty = lowerLog.evicted[i].second;
+            lowerAccesses.erase(w);
+            bool upperDirty = false;
+            if (inclusive && upper->remove(w, upperDirty)) {
+                backInvalidations++;
+                dirty = dirty || upperDirty;
+            }
+            if (dirty) evictedDirtyPage++;
+            owner->notifyEvict(w, dirty);
+        }
+        lowerLog.evicted.clear();
+    }
+
+    bool access(long long k, const string& rw) {
+        calls++;
+        bool write = isWrite(rw);
+
+        if (upper->contains(k)) {
+            upperHits++;
+            upper->refer(k, rw);
+            drain();
+            return true;
+        }
+
+        if (lower->contains(k)) {
+            lowerHits++;
+            if (inclusive) {
+                lower->refer(k, rw);
+                if (promotable(k)) {
+                    promotions++;
+                    upper->refer(k, rw);
+                }
+            } else if (promotable(k)) {
+                bool dirty = false;
+                lower->remove(k, dirty);
+                promotions++;
+                upper->refer(k, rwOf(dirty || write));
+            } else {
+                lower->refer(k, rw);
+            }
+            drain();
+            return true;
+        }
+
+        misses++;
+        if (promoteAfter <= 1) {
+            if (inclusive) {
+                lower->refer(k, rw);
+                drain();
+            }
+            upper->refer(k, rw);
+        } else {
+            lower->refer(k, rw);
+            lowerAccesses[k] = 1;
+        }
+        drain();
+        return false;
+    }
+};
+
+TieredCache::TieredCache(CachePolicy* upper, CachePolicy* lower, const string& policy,
+                         int upperSize, int lowerSize, bool inclusive, int promoteAfter,
+                         const TierCosts& costs)
+{
+    p = new Impl();
+    p->owner = this;
+    p->upper = upper;
+    p->lower = lower;
+    p->policy = policy;
+    p->upperSize = upperSize;
+    p->lowerSize = lowerSize;
+    p->inclusive = inclusive;
+    p->promoteAfter = max(1, promoteAfter);
+    p->costs = costs;
+    upper->setObserver(&p->upperLog);
+    lower->setObserver(&p->lowerLog);
+}
+
+TieredCache::~TieredCache()
+{
+    delete p->upper;
+    delete p->lower;
+    delete p;
+}
+
+void TieredCache::refer(long long int addr, string rw)
+{
+    bool hit = p->access(addr, rw);
+    notifyAccess(addr, Impl::isWrite(rw), hit);
+}
+
+bool TieredCache::contains(long long int addr)
+{
+    return p->upper->contains(addr) || p->lower->contains(addr);
+}
+
+long long int TieredCache::victim()
+{
+    // whatever leaves the hierarchy leaves from the lower tier
+    return p->lower->victim();
+}
+
+void TieredCache::report()
+{
+    const TierCosts& c = p->costs;
+    long long hits = p->upperHits + p->lowerHits;
+    double serviceUs = p->upperHits * c.upperUs + p->lowerHits * c.lowerUs + p->misses * c.missUs;
+    double migrationUs = p->promotions * (c.lowerUs + c.upperUs) + p->demotions * c.lowerWriteUs;
+    double migratedMB = (double)(p->promotions + p->demotions) * 4 / 1024;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "Tiered " << p->policy
+            << " " << (p->inclusive ? "inclusive" : "exclusive")
+            << " promoteAfter " << p->promoteAfter
+            << " upperSize " << p->upperSize
+            << " lowerSize " << p->lowerSize
+            << " calls " << p->calls
+            << " hits " << hits
+            << " hitRatio " << (p->calls ? (double)hits / p->calls : 0.0)
+            << " upperHits " << p->upperHits
+            << " lowerHits " << p->lowerHits
+            << " promotions " << p->promotions
+            << " demotions " << p->demotions
+            << " dirtyDemotions " << p->dirtyDemotions
+            << " backInvalidations " << p->backInvalidations
+            << " migratedMB " << migratedMB
+            << " evictedDirtyPage " << p->evictedDirtyPage
+            << " meanAccessUs " << (p->calls ? (serviceUs + migrationUs) / p->calls : 0.0)
+            << " migrationUsPerRef " << (p->calls ? migrationUs / p->calls : 0.0)
+            << endl;
+    }
+}
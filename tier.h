@@ -0,0 +1,52 @@
+#ifndef _tier_H
+#define _tier_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+// Per-page (4KB) access costs of the two tiers and the backing store
+struct TierCosts
+{
+    double upperUs;        // hit in the upper tier (DRAM)
+    double lowerUs;        // hit in, or read from, the lower tier (PMEM/NVMe)
+    double lowerWriteUs;   // write of a demoted page into the lower tier
+    double missUs;         // read from the backing device
+};
+
+/*
+   Two policy instances stacked as a cache hierarchy. The upper tier is
+   small and fast, the lower one large and slower; both run the same
+   replacement policy at their own capacity.
+
+   Exclusive: a page lives in one tier. Upper-tier evictions are demoted
+   into the lower tier, and a lower-tier page moves up once it has been
+   accessed promoteAfter times there.
+   Inclusive: the lower tier holds every cached page. Upper-tier copies are
+   made after promoteAfter lower-tier accesses, dirty upper evictions are
+   written back down, and lower-tier evictions invalidate the upper copy.
+
+   With promoteAfter 1, misses are filled straight into the upper tier
+   (both tiers when inclusive); otherwise they go to the lower tier first.
+*/
+class TieredCache : public CachePolicy
+{
+public:
+    // takes ownership of both policies, which must support remove()
+    TieredCache(CachePolicy* upper, CachePolicy* lower, const string& policy,
+                int upperSize, int lowerSize, bool inclusive, int promoteAfter,
+                const TierCosts& costs);
+    ~TieredCache();
+
+    void refer(long long int addr, string rw);
+
+    void report();
+    bool contains(long long int addr);
+    long long int victim();
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
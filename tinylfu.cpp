@@ -0,0 +1,260 @@
+#include "tinylfu.h"
+#include "hash.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+// Count-min sketch of 4-bit counters (16 per 64-bit word, 4 rows) plus a
+// doorkeeper Bloom filter. The first sighting of a key only sets its
+// doorkeeper bits; later ones increment the sketch. After sampleSize
+// increments every counter is halved and the doorkeeper is cleared, so
+// old popularity fades out.
+class FrequencySketch
+{
+public:
+    void init(int capacity)
+    {
+        width = 16;
+        while (width < (uint64_t)capacity) width <<= 1;
+        table.assign(width * DEPTH / 16, 0);
+        doorBits = width * 8;
+        door.assign(doorBits / 64, 0);
+        sampleSize = 10LL * max(capacity, 1);
+        additions = 0;
+        resets = 0;
+    }
+
+    int frequency(long long key) const
+    {
+        uint64_t h = mix64((uint64_t)key);
+        int f = 15;
+        for (int i = 0; i < DEPTH; i++) f = min(f, counter(i, h));
+        return f + (inDoor(h) ? 1 : 0);
+    }
+
+    void increment(long long key)
+    {
+        uint64_t h = mix64((uint64_t)key);
+        if (!inDoor(h)) {
+            addDoor(h);
+        } else {
+            for (int i = 0; i < DEPTH; i++) {
+                uint64_t c = slot(i, h);
+                uint64_t& w = table[c >> 4];
+                int shift = (int)(c & 15) * 4;
+                if (((w >> shift) & 0xF) < 15) w += 1ULL << shift;
+            }
+        }
+        if (++additions >= sampleSize) reset();
+    }
+
+    size_t bytes() const { return (table.size() + door.size()) * sizeof(uint64_t); }
+    long long resetCount() const { return resets; }
+
+private:
+    static const int DEPTH = 4;
+
+    vector<uint64_t> table;
+    vector<uint64_t> door;
+    uint64_t width = 0;     // counters per row, power of two
+    uint64_t doorBits = 0;
+    long long sampleSize = 0;
+    long long additions = 0;
+    long long resets = 0;
+
+    // double hashing: row i uses h1 + i * h2
+    uint64_t slot(int i, uint64_t h) const
+    {
+        uint64_t h1 = h & 0xffffffffULL;
+        uint64_t h2 = (h >> 32) | 1;
+        return (uint64_t)i * width + ((h1 + i * h2) & (width - 1));
+    }
+
+    int counter(int i, uint64_t h) const
+    {
+        uint64_t c = slot(i, h);
+        return (int)((table[c >> 4] >> ((c & 15) * 4)) & 0xF);
+    }
+
+    bool inDoor(uint64_t h) const
+    {
+        uint64_t d = mix64(h);
+        uint64_t b1 = d & (doorBits - 1), b2 = (d >> 32) & (doorBits - 1);
+        return ((door[b1 >> 6] >> (b1 & 63)) & 1) && ((door[b2 >> 6] >> (b2 & 63)) & 1);
+    }
+
+    void addDoor(uint64_t h)
+    {
+        uint64_t d = mix64(h);
+        uint64_t b1 = d & (doorBits - 1), b2 = (d >> 32) & (doorBits - 1);
+        door[b1 >> 6] |= 1ULL << (b1 & 63);
+        door[b2 >> 6] |= 1ULL << (b2 & 63);
+    }
+
+    void reset()
+    {
+        for (size_t i = 0; i < table.size(); i++) table[i] = (table[i] >> 1) & 0x7777777777777777ULL;
+        fill(door.begin(), door.end(), 0);
+        additions /= 2;
+        resets++;
+    }
+};
+
+struct TinyLFUCache::Impl : public CacheObserver
+{
+    TinyLFUCache* owner = nullptr;
+    CachePolicy* mainPolicy = nullptr;
+    string mainName;
+    int capacity = 0;
+    int windowCap = 0;
+
+    FrequencySketch sketch;
+
+    // Window LRU (MRU at front), value: position and dirty bit
+    list<long long> window;
+    unordered_map<long long, pair<list<long long>::iterator, bool> > winPos;
+
+    long long calls = 0;
+    long long hits = 0;
+    long long readHits = 0;
+    long long writeHits = 0;
+    long long windowHits = 0;
+    long long admitted = 0;
+    long long rejected = 0;
+    long long evictedDirtyPage = 0;
+
+    static bool isWrite(const string& rw) {
+        return (rw == "Write" || rw == "write" || rw == "W" || rw == "w");
+    }
+
+    // evictions inside the main policy are evictions of the whole cache
+    void onEvictFrom(long long int addr, bool dirty, int segment) {
+        if (dirty) evictedDirtyPage++;
+        owner->notifyEvict(addr, dirty, segment);
+    }
+
+    // The window's LRU page competes with the main policy's victim
+    void admit(long long cand, bool dirty) {
+        long long v = mainPolicy->victim();
+        if (v == -1 || sketch.frequency(cand) > sketch.frequency(v)) {
+            admitted++;
+            mainPolicy->refer(cand, dirty ? "Write" : "Read");
+        } else {
+            rejected++;
+            if (dirty) evictedDirtyPage++;
+            owner->notifyEvict(cand, dirty, SEG_WINDOW);
+        }
+    }
+
+    void access(long long k, const string& rw) {
+        calls++;
+        bool write = isWrite(rw);
+        sketch.increment(k);
+
+        auto w = winPos.find(k);
+        if (w != winPos.end()) {
+            hits++;
+            windowHits++;
+            if (write) writeHits++; else readHits++;
+            window.erase(w->second.first);
+            window.push_front(k);
+            w->second.first = window.begin();
+            w->second.second = w->second.second || write;
+            owner->notifyAccess(k, write, true);
+            return;
+        }
+
+        if (mainPolicy->contains(k)) {
+            hits++;
+            if (write) writeHits++; else readHits++;
+            mainPolicy->refer(k, rw);
+            owner->notifyAccess(k, write, true);
+            return;
+        }
+
+        window.push_front(k);
+        winPos[k] = make_pair(window.begin(), write);
+        if ((int)window.size() > windowCap) {
+            long long cand = window.back();
+            bool dirty = winPos[cand].second;
+            window.pop_back();
+            winPos.erase(cand);
+            admit(cand, dirty);
+        }
+        owner->notifyAccess(k, write, false);
+    }
+};
+
+TinyLFUCache::TinyLFUCache(CachePolicy* mainPolicy, const string& mainName, int capacity, int window)
+{
+    p = new Impl();
+    p->owner = this;
+    p->mainPolicy = mainPolicy;
+    p->mainName = mainName;
+    p->capacity = capacity;
+    p->windowCap = max(1, window);
+    p->sketch.init(capacity);
+    p->winPos.reserve(p->windowCap + 1);
+    mainPolicy->setObserver(p);
+}
+
+TinyLFUCache::~TinyLFUCache()
+{
+    delete p->mainPolicy;
+    delete p;
+}
+
+int TinyLFUCache::windowFor(int capacity)
+{
+    return max(1, min(capacity / 100, capacity - 1));
+}
+
+void TinyLFUCache::refer(long long int addr, string rw)
+{
+    p->access(addr, rw);
+}
+
+bool TinyLFUCache::contains(long long int addr)
+{
+    return p->winPos.find(addr) != p->winPos.end() || p->mainPolicy->contains(addr);
+}
+
+long long int TinyLFUCache::victim()
+{
+    // a miss pushes the window's LRU page towards admission
+    if ((int)p->window.size() < p->windowCap) return -1;
+    return p->window.back();
+}
+
+void TinyLFUCache::report()
+{
+    double bytesPerKey = p->capacity > 0 ? (double)p->sketch.bytes() / p->capacity : 0.0;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "TinyLFU-" << p->mainName
+            << " CacheSize " << p->capacity
+            << " window " << p->windowCap
+            << " calls " << p->calls
+            << " hits " << p->hits
+            << " hitRatio " << (p->calls ? (double)p->hits / p->calls : 0.0)
+            << " readHits " << p->readHits
+            << " writeHits " << p->writeHits
+            << " evictedDirtyPage " << p->evictedDirtyPage
+            << " windowHits " << p->windowHits
+            << " admitted " << p->admitted
+            << " rejected " << p->rejected
+            << " sketchResets " << p->sketch.resetCount()
+            << " sketchBytesPerKey " << bytesPerKey
+            << endl;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef _tinylfu_H
+#define _tinylfu_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   W-TinyLFU admission in front of any policy. New pages enter a small
+   window LRU; the page pushed out of the window is only admitted into the
+   main policy if its estimated frequency beats the frequency of the page
+   the main policy would evict. Frequencies come from a 4-bit count-min
+   sketch whose counters are halved periodically, behind a doorkeeper Bloom
+   filter that absorbs one-hit wonders.
+*/
+class TinyLFUCache : public CachePolicy
+{
+public:
+    // takes ownership of mainPolicy, which should be sized capacity - window
+    TinyLFUCache(CachePolicy* mainPolicy, const string& mainName, int capacity, int window);
+    ~TinyLFUCache();
+
+    void refer(long long int addr, string rw);
+    void report();
+    bool contains(long long int addr);
+    long long int victim();
+
+    // the usual 1% window, leaving the main policy at least one page
+    static int windowFor(int capacity);
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
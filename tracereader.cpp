@@ -0,0 +1,289 @@
+#include "tracereader.h"
+
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <ctype.h>
+
+using namespace std;
+
+const string& TraceRecord::rwName() const
+{
+    static const string names[3] = { "", "Read", "Write" };
+    return names[(int)rw];
+}
+
+struct TraceReader::Impl
+{
+    static const size_t CHUNK = 4 << 20;    // bytes per read()
+    static const size_t SLOTS = 16;         // batches in flight, power of two
+    static const size_t BATCH = 4096;       // requests per batch
+
+    int fd = -1;
+    bool ownFd = true;      // false for stdin
+    bool regular = false;   // a file the kernel can read ahead in; pipes are not
+    int traceType = 0;
+    off_t readPos = 0;
+
+    // The reader fills slots[tail % SLOTS] and publishes it by bumping
+    // tail; the simulation drains slots[head % SLOTS] and hands it back
+    // by bumping head. Each index is written by one side only.
+    vector<TraceRecord> slots[SLOTS];
+    atomic<size_t> head;
+    atomic<size_t> tail;
+    atomic<bool> done;
+    atomic<bool> stop;
+    thread worker;
+    bool started = false;
+
+    // tenant ids, owned by the reader thread until done is set
+    unordered_map<string, int> tenantIds;
+    vector<string> tenantNames;
+    string lastTenant;
+    int lastTenantId = -1;
+
+    size_t pos = 0;         // next record of the batch at head
+    size_t seenTail = 0;    // last tail the simulation read, saves a load per record
+
+    Impl() : head(0), tail(0), done(false), stop(false) {}
+
+    // Spin briefly, then give the CPU away: with fewer cores than threads
+    // the other side needs it to make progress
+    static void backoff(int& spins) {
+        if (++spins < 64) return;
+        this_thread::yield();
+    }
+
+    static long long parseInt(const char*& s, const char* end) {
+        while (s < end && (*s == ' ' || *s == '\t')) s++;
+        bool neg = false;
+        if (s < end && (*s == '-' || *s == '+')) neg = *s++ == '-';
+        long long v = 0;
+        while (s < end && *s >= '0' && *s <= '9') v = v * 10 + (*s++ - '0');
+        return neg ? -v : v;
+    }
+
+    static char parseRW(const char* s, const char* end) {
+        size_t n = end - s;
+        if ((n == 5 && (memcmp(s, "Write", 5) == 0 || memcmp(s, "write", 5) == 0))
+            || (n == 1 && (*s == 'W' || *s == 'w'))) return TraceRecord::WRITE;
+        return TraceRecord::READ;
+    }
+
+    // consecutive rows mostly come from the same volume
+    int tenantOf(const char* dev, const char* devEnd, const char* disk, const char* diskEnd) {
+        size_t devLen = devEnd - dev, diskLen = diskEnd - disk;
+        if (lastTenantId >= 0 && lastTenant.size() == devLen + 1 + diskLen
+            && lastTenant.compare(0, devLen, dev, devLen) == 0
+            && lastTenant.compare(devLen + 1, diskLen, disk, diskLen) == 0) return lastTenantId;
+        lastTenant.assign(dev, devLen);
+        lastTenant += ':';
+        lastTenant.append(disk, diskLen);
+        auto it = tenantIds.find(lastTenant);
+        if (it == tenantIds.end()) {
+            it = tenantIds.insert(make_pair(lastTenant, (int)tenantNames.size())).first;
+            tenantNames.push_back(lastTenant);
+        }
+        lastTenantId = it->second;
+        return lastTenantId;
+    }
+
+    // "timestamp,device,disk,type,offset,size,responseTime"
+    bool parseMSR(const char* s, const char* end, TraceRecord& r) {
+        const char* field[7];
+        const char* fieldEnd[7];
+        int n = 0;
+        const char* f = s;
+        for (const char* c = s; n < 7; c++) {
+            if (c == end || *c == ',') {
+                field[n] = f;
+                fieldEnd[n++] = c;
+                f = c + 1;
+                if (c == end) break;
+            }
+        }
+        if (n < 6 || field[0] == fieldEnd[0]) return false;
+        r.timestamp = parseInt(field[0], fieldEnd[0]);
+        r.rw = parseRW(field[3], fieldEnd[3]);
+        r.offset = parseInt(field[4], fieldEnd[4]);
+        r.size = (int)parseInt(field[5], fieldEnd[5]);
+        r.tenant = tenantOf(field[1], fieldEnd[1], field[2], fieldEnd[2]);
+        return true;
+    }
+
+    // "timestamp key pattern", whitespace separated
+    static bool parseTPCH(const char* s, const char* end, TraceRecord& r) {
+        const char* tok[3];
+        int n = 0;
+        for (const char* c = s; c < end && n < 3; ) {
+            while (c < end && isspace((unsigned char)*c)) c++;
+            if (c == end) break;
+            tok[n++] = c;
+            while (c < end && !isspace((unsigned char)*c)) c++;
+        }
+        if (n < 3) return false;
+        r.timestamp = -1;
+        r.offset = strtoll(tok[1], NULL, 10);
+        r.size = 0;
+        r.tenant = 0;
+        r.rw = TraceRecord::NONE;
+        return true;
+    }
+
+    // Wait for a free slot; false if the consumer went away
+    bool acquireSlot(size_t t) {
+        int spins = 0;
+        while (t - head.load(memory_order_acquire) >= SLOTS) {
+            if (stop.load(memory_order_relaxed)) return false;
+            backoff(spins);
+        }
+        return true;
+    }
+
+    void produce() {
+        vector<char> buf(CHUNK);
+        size_t carry = 0;
+        size_t t = tail.load(memory_order_relaxed);
+        if (!acquireSlot(t)) return;
+        vector<TraceRecord>* batch = &slots[t & (SLOTS - 1)];
+        batch->clear();
+
+        bool eof = false;
+        while (!eof) {
+            ssize_t n = read(fd, buf.data() + carry, buf.size() - carry);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                eof = true;
+                n = 0;
+            } else {
+                readPos += n;
+#ifdef POSIX_FADV_WILLNEED
+                if (regular) posix_fadvise(fd, readPos, CHUNK, POSIX_FADV_WILLNEED);
+#endif
+            }
+
+            const char* s = buf.data();
+            const char* end = s + carry + n;
+            for (;;) {
+                const char* nl = (const char*)memchr(s, '\n', end - s);
+                // the tail of the last chunk is a line of its own, and so is
+                // a line too long for the buffer
+                if (!nl && !eof && !(s == buf.data() && end == s + buf.size())) break;
+                const char* lineEnd = nl ? nl : end;
+                if (lineEnd > s && lineEnd[-1] == '\r') lineEnd--;
+
+                TraceRecord r;
+                bool parsed = traceType == 2 ? parseMSR(s, lineEnd, r) : parseTPCH(s, lineEnd, r);
+                if (parsed) {
+                    batch->push_back(r);
+                    if (batch->size() >= BATCH) {
+                        tail.store(++t, memory_order_release);
+                        if (!acquireSlot(t)) return;
+                        batch = &slots[t & (SLOTS - 1)];
+                        batch->clear();
+                    }
+                }
+                if (!nl) {
+                    s = end;
+                    break;
+                }
+                s = nl + 1;
+            }
+            carry = end - s;
+            memmove(buf.data(), s, carry);
+        }
+        if (!batch->empty()) tail.store(++t, memory_order_release);
+        done.store(true, memory_order_release);
+    }
+
+    void start() {
+        started = true;
+        for (size_t i = 0; i < SLOTS; i++) slots[i].reserve(BATCH);
+#ifdef POSIX_FADV_SEQUENTIAL
+        if (regular) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        worker = thread(&Impl::produce, this);
+    }
+};
+
+TraceReader::TraceReader(const char* filename, int traceType)
+{
+    p = new Impl();
+    // "-" is stdin: a pipe from a decompressor, read front to back once
+    if (strcmp(filename, "-") == 0) {
+        p->fd = STDIN_FILENO;
+        p->ownFd = false;
+    } else {
+        p->fd = open(filename, O_RDONLY);
+    }
+    p->traceType = traceType;
+    struct stat st;
+    if (p->fd >= 0 && fstat(p->fd, &st) == 0) {
+        p->regular = S_ISREG(st.st_mode);
+#ifdef F_SETPIPE_SZ
+        // the default 64KB pipe wakes the reader for every few hundred
+        // lines; best effort, unprivileged limits may refuse it
+        if (S_ISFIFO(st.st_mode)) fcntl(p->fd, F_SETPIPE_SZ, 1 << 20);
+#endif
+    }
+}
+
+TraceReader::~TraceReader()
+{
+    if (p->started) {
+        p->stop.store(true);
+        p->worker.join();
+    }
+    if (p->fd >= 0 && p->ownFd) close(p->fd);
+    delete p;
+}
+
+string TraceReader::tenantName(int tenant) const
+{
+    if (p->traceType != 2) return "all";
+    if (tenant < 0 || tenant >= (int)p->tenantNames.size()) return "?";
+    return p->tenantNames[tenant];
+}
+
+int TraceReader::tenants() const
+{
+    return p->traceType != 2 ? 1 : (int)p->tenantNames.size();
+}
+
+bool TraceReader::ok() const
+{
+    return p->fd >= 0;
+}
+
+bool TraceReader::next(TraceRecord& r)
+{
+    if (p->fd < 0) return false;
+    if (!p->started) p->start();
+
+    size_t h = p->head.load(memory_order_relaxed);
+    int spins = 0;
+    for (;;) {
+        if (h != p->seenTail || h != (p->seenTail = p->tail.load(memory_order_acquire))) {
+            vector<TraceRecord>& batch = p->slots[h & (Impl::SLOTS - 1)];
+            if (p->pos < batch.size()) {
+                r = batch[p->pos++];
+                return true;
+            }
+            // batch drained, hand the slot back to the reader
+            p->pos = 0;
+            p->head.store(++h, memory_order_release);
+            spins = 0;
+            continue;
+        }
+        // done is set after the last batch was published
+        if (p->done.load(memory_order_acquire) && h == p->tail.load(memory_order_acquire)) return false;
+        Impl::backoff(spins);
+    }
+}
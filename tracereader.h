@@ -0,0 +1,52 @@
+#ifndef _tracereader_H
+#define _tracereader_H
+
+#include <string>
+using namespace std;
+
+// One request of the trace. MSR rows carry a byte range; TPC-H rows
+// ("timestamp key pattern") carry a page key in offset and size 0.
+struct TraceRecord
+{
+    enum { NONE = 0, READ = 1, WRITE = 2 };
+
+    long long timestamp;    // -1 for TPC-H rows
+    long long offset;
+    int size;
+    int tenant;             // dense id of the (device, disk) pair, 0 for TPC-H
+    char rw;
+
+    // the string the policies' refer() expects
+    const string& rwName() const;
+};
+
+/*
+   Reads and parses a trace on a thread of its own. The reader pulls the
+   file in large read()s, hinting the kernel to fetch the next chunk while
+   the current one is parsed, and hands parsed requests over in batches
+   through a single-producer/single-consumer ring. The simulation only
+   drains the ring, so I/O and parsing overlap with refer().
+*/
+class TraceReader
+{
+public:
+    // filename "-" reads standard input, e.g. a pipe from zstdcat
+    TraceReader(const char* filename, int traceType);
+    ~TraceReader();
+
+    bool ok() const;
+
+    // next request in trace order, false at the end of the trace; the
+    // reader thread starts on the first call
+    bool next(TraceRecord& r);
+
+    // "device:disk" of a tenant id; valid once next() returned false
+    string tenantName(int tenant) const;
+    int tenants() const;
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "tune.h"
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <stdlib.h>
+
+using namespace std;
+
+// Tunables by name, the policy they belong to and where they live
+struct TunableInfo
+{
+    const char* name;
+    const char* policy;
+    double PolicyParams::* field;
+};
+
+static const TunableInfo tunables[] = {
+    { "hirShare", "LIRS", &PolicyParams::lirsHirShare },
+    { "historyFraction", "CACHEUS", &PolicyParams::cacheusHistory },
+    { "alpha", "CACHEUS", &PolicyParams::cacheusAlpha },
+    { "ghostFactor", "ARC", &PolicyParams::arcGhostFactor },
+};
+
+static const TunableInfo* findTunable(const string& name)
+{
+    for (size_t i = 0; i < sizeof(tunables) / sizeof(tunables[0]); i++) {
+        if (name == tunables[i].name) return &tunables[i];
+    }
+    return NULL;
+}
+
+bool parseTuneRanges(const string& spec, const string& policy, vector<TuneRange>& out)
+{
+    stringstream ss(spec);
+    string item;
+    while (getline(ss, item, ',')) {
+        TuneRange r;
+        size_t eq = item.find('=');
+        r.name = item.substr(0, eq);
+        const TunableInfo* t = findTunable(r.name);
+        if (eq == string::npos || !t) {
+            cerr << "unknown tunable " << r.name << endl;
+            return false;
+        }
+        if (policy != t->policy) {
+            cerr << r.name << " is a " << t->policy << " parameter" << endl;
+            return false;
+        }
+        char c1, c2;
+        stringstream vs(item.substr(eq + 1));
+        if (!(vs >> r.lo >> c1 >> r.hi >> c2 >> r.steps) || c1 != ':' || c2 != ':' || r.steps < 1) {
+            cerr << "expected " << r.name << "=lo:hi:steps" << endl;
+            return false;
+        }
+        out.push_back(r);
+    }
+    return !out.empty();
+}
+
+PolicyTuner::PolicyTuner(const string& policy, PolicyMaker make, const PolicyParams& base,
+                         const vector<TuneRange>& ranges,
+                         const vector<long long>& keys, const vector<char>& writes, int threads)
+    : policy(policy), make(make), base(base), ranges(ranges),
+      keys(keys), writes(writes), threads(max(1, threads))
+{
+}
+
+double PolicyTuner::evaluate(const PolicyParams& params, int csize, size_t len) const
+{
+    static const string read = "Read", write = "Write";
+    CachePolicy* ca = make(policy, csize, params);
+    HitCounter counter;
+    ca->setObserver(&counter);
+    for (size_t i = 0; i < len; i++) ca->refer(keys[i], writes[i] ? write : read);
+    delete ca;
+    return counter.hitRatio();
+}
+
+struct Candidate
+{
+    PolicyParams params;
+    string label;
+    double score;
+};
+
+void PolicyTuner::tune(int csize)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // the full grid
+    vector<Candidate> grid(1);
+    grid[0].params = base;
+    for (size_t r = 0; r < ranges.size(); r++) {
+        const TuneRange& range = ranges[r];
+        double PolicyParams::* field = findTunable(range.name)->field;
+        vector<Candidate> next;
+        for (size_t g = 0; g < grid.size(); g++) {
+            for (int s = 0; s < range.steps; s++) {
+                double v = range.steps == 1 ? range.lo
+                    : range.lo + (range.hi - range.lo) * s / (range.steps - 1);
+                Candidate c = grid[g];
+                c.params.*field = v;
+                ostringstream label;
+                label << (c.label.empty() ? "" : ",") << range.name << "=" << v;
+                c.label += label.str();
+                next.push_back(c);
+            }
+        }
+        grid.swap(next);
+    }
+
+    vector<Candidate*> alive;
+    for (size_t i = 0; i < grid.size(); i++) alive.push_back(&grid[i]);
+    int rounds = 1;
+    while ((size_t)1 << (rounds - 1) < alive.size()) rounds++;
+
+    Candidate defaults;
+    defaults.params = base;
+    defaults.label = "default";
+
+    // a prefix shorter than a few cache fills only measures cold misses
+    size_t n = keys.size();
+    size_t minLen = min(n, (size_t)max(csize, 1) * 4);
+    long long evaluatedRefs = 0;
+
+    for (int r = 0; r < rounds; r++) {
+        size_t len = max(n >> (rounds - 1 - r), minLen);
+        vector<Candidate*> jobs(alive);
+        if (r == rounds - 1) jobs.push_back(&defaults);
+
+        atomic<size_t> nextJob(0);
+        vector<thread> pool;
+        int workers = min((int)jobs.size(), threads);
+        for (int w = 0; w < workers; w++) {
+            pool.push_back(thread([&]() {
+                for (size_t i; (i = nextJob++) < jobs.size();) {
+                    jobs[i]->score = evaluate(jobs[i]->params, csize, len);
+                }
+            }));
+        }
+        for (size_t w = 0; w < pool.size(); w++) pool[w].join();
+        evaluatedRefs += (long long)len * jobs.size();
+
+        stable_sort(alive.begin(), alive.end(),
+                    [](const Candidate* a, const Candidate* b) { return a->score > b->score; });
+        if (r < rounds - 1) alive.resize((alive.size() + 1) / 2);
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    // the defaults ran on the full trace too; short prefixes can mislead
+    // the early rounds, so the search may not find anything better
+    const Candidate& best = alive[0]->score >= defaults.score ? *alive[0] : defaults;
+
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "Tune " << policy
+            << " CacheSize " << csize
+            << " refs " << n
+            << " candidates " << grid.size()
+            << " rounds " << rounds
+            << " evaluatedRefs " << evaluatedRefs
+            << " best " << best.label
+            << " bestHitRatio " << best.score
+            << " defaultHitRatio " << defaults.score
+            << " seconds " << elapsed.count()
+            << endl;
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef _tune_H
+#define _tune_H
+
+#include <string>
+#include <vector>
+#include "policy.h"
+using namespace std;
+
+typedef CachePolicy* (*PolicyMaker)(const string& name, int csize, const PolicyParams& params);
+
+// One tunable swept linearly from lo to hi in steps values
+struct TuneRange
+{
+    string name;
+    double lo, hi;
+    int steps;
+};
+
+// "name=lo:hi:steps[,name=lo:hi:steps...]"; the names must belong to the
+// policy (hirShare for LIRS, historyFraction and alpha for CACHEUS,
+// ghostFactor for ARC). Prints the problem and returns false otherwise.
+bool parseTuneRanges(const string& spec, const string& policy, vector<TuneRange>& out);
+
+/*
+   Successive halving over the grid of parameter values. Every candidate
+   is replayed on a short prefix of the trace; the better half survives
+   and is replayed on a prefix twice as long, until one remains for the
+   full trace, where it is compared with the default configuration.
+   Candidates of a round run in parallel, each on its own policy
+   instance, so a whole sweep costs a few full replays.
+*/
+class PolicyTuner
+{
+public:
+    PolicyTuner(const string& policy, PolicyMaker make, const PolicyParams& base,
+                const vector<TuneRange>& ranges,
+                const vector<long long>& keys, const vector<char>& writes, int threads);
+
+    // tune for one cache size and print the best configuration
+    void tune(int csize);
+
+private:
+    string policy;
+    PolicyMaker make;
+    PolicyParams base;
+    vector<TuneRange> ranges;
+    const vector<long long>& keys;
+    const vector<char>& writes;
+    int threads;
+
+    double evaluate(const PolicyParams& params, int csize, size_t len) const;
+};
+
+#endif
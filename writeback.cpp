@@ -0,0 +1,177 @@
+#include "writeback.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+static const long long PAGE = 4 * 1024;
+static const int MAX_IO_PAGES = 256;         // largest coalesced write: 1MB
+static const int QUEUE_PAGES = 128;          // flush queue is issued when this full
+static const long long FLUSH_INTERVAL = 10000; // references between periodic flushes
+static const int SIZE_BUCKETS = 9;           // 1, 2, 4 ... 256 pages
+
+struct WriteBackFlusher::Impl
+{
+    int csize = 0;
+    double dirtyRatio = 0;
+    long long dirtyLimit = 0;  // background flush starts above this many dirty pages
+    long long expireAge = 0;   // periodic flush writes pages dirty for longer than this
+
+    long long refs = 0;
+
+    // Dirty resident pages, oldest at back; value is the reference number it got dirty
+    list<long long> dirtyAge;
+    unordered_map<long long, pair<long long, list<long long>::iterator> > dirty;
+
+    // Pages waiting to be written
+    vector<long long> queue;
+
+    // Stats
+    long long dirtyEvictions = 0;   // writes caused by evicting a dirty page
+    long long backgroundPages = 0;  // pages cleaned by background/periodic flushing
+    long long clusteredPages = 0;   // resident dirty neighbours written along with them
+    long long writeIOs = 0;
+    long long writePages = 0;
+    long long sizeHist[SIZE_BUCKETS] = { 0 };
+
+    bool isDirty(long long k) const { return dirty.find(k) != dirty.end(); }
+
+    void clean(long long k) {
+        auto it = dirty.find(k);
+        if (it == dirty.end()) return;
+        dirtyAge.erase(it->second.second);
+        dirty.erase(it);
+    }
+
+    // Queue page k for writing, together with the dirty pages right next to it
+    // so the write goes out as one sequential I/O.
+    void enqueueClustered(long long k) {
+        queue.push_back(k);
+        for (long long n = k + PAGE; isDirty(n) && n < k + MAX_IO_PAGES * PAGE; n += PAGE) {
+            clean(n);
+            queue.push_back(n);
+            clusteredPages++;
+        }
+        for (long long n = k - PAGE; isDirty(n) && n > k - MAX_IO_PAGES * PAGE; n -= PAGE) {
+            clean(n);
+            queue.push_back(n);
+            clusteredPages++;
+        }
+        if ((int)queue.size() >= QUEUE_PAGES) issue();
+    }
+
+    void flushOldest() {
+        long long k = dirtyAge.back();
+        clean(k);
+        backgroundPages++;
+        enqueueClustered(k);
+    }
+
+    // Sort the queue and turn runs of adjacent pages into write I/Os.
+    void issue() {
+        if (queue.empty()) return;
+        sort(queue.begin(), queue.end());
+        queue.erase(unique(queue.begin(), queue.end()), queue.end());
+
+        size_t i = 0;
+        while (i < queue.size()) {
+            size_t j = i + 1;
+            while (j < queue.size() && queue[j] == queue[j - 1] + PAGE && (int)(j - i) < MAX_IO_PAGES) j++;
+            int pages = (int)(j - i);
+            writeIOs++;
+            writePages += pages;
+            int b = 0;
+            while ((1 << (b + 1)) <= pages && b < SIZE_BUCKETS - 1) b++;
+            sizeHist[b]++;
+            i = j;
+        }
+        queue.clear();
+    }
+
+    void access(long long k, bool write) {
+        refs++;
+        if (write && !isDirty(k)) {
+            dirtyAge.push_front(k);
+            dirty[k] = make_pair(refs, dirtyAge.begin());
+        }
+
+        // Background writeback: dirty share above the threshold
+        while ((long long)dirty.size() > dirtyLimit && !dirtyAge.empty()) {
+            flushOldest();
+        }
+
+        // Periodic writeback of expired pages
+        if (refs % FLUSH_INTERVAL == 0) {
+            while (!dirtyAge.empty() && refs - dirty[dirtyAge.back()].first > expireAge) {
+                flushOldest();
+            }
+            issue();
+        }
+    }
+
+    void evict(long long k) {
+        if (!isDirty(k)) return;
+        clean(k);
+        dirtyEvictions++;
+        enqueueClustered(k);
+    }
+};
+
+WriteBackFlusher::WriteBackFlusher(int cacheSize, double dirtyRatio)
+{
+    p = new Impl();
+    p->csize = cacheSize;
+    p->dirtyRatio = dirtyRatio;
+    p->dirtyLimit = max(1LL, (long long)(cacheSize * dirtyRatio));
+    // a page expires once the cache could have turned over completely
+    p->expireAge = max(FLUSH_INTERVAL, (long long)cacheSize);
+    p->dirty.reserve(p->dirtyLimit + 16);
+}
+
+WriteBackFlusher::~WriteBackFlusher()
+{
+    delete p;
+}
+
+void WriteBackFlusher::onEvict(long long int addr, bool dirty)
+{
+    p->evict(addr);
+}
+
+void WriteBackFlusher::onAccess(long long int addr, bool write, bool hit)
+{
+    p->access(addr, write);
+}
+
+void WriteBackFlusher::finish()
+{
+    p->issue();
+}
+
+void WriteBackFlusher::report(const string& policy)
+{
+    ofstream result("ExperimentalResult.txt", ios_base::app);
+    ostream* outs[2] = { &cout, &result };
+    for (int o = 0; o < 2; o++) {
+        ostream& out = *outs[o];
+        if (o == 1 && !result.is_open()) break;
+        out << "WriteBack " << policy
+            << " CacheSize " << p->csize
+            << " dirtyRatio " << p->dirtyRatio
+            << " dirtyEvictions " << p->dirtyEvictions
+            << " backgroundPages " << p->backgroundPages
+            << " clusteredPages " << p->clusteredPages
+            << " writeIOs " << p->writeIOs
+            << " writePages " << p->writePages
+            << " avgIOPages " << (p->writeIOs > 0 ? (double)p->writePages / p->writeIOs : 0.0)
+            << " dirtyResident " << p->dirty.size()
+            << " ioSizeHist";
+        for (int b = 0; b < SIZE_BUCKETS; b++) out << " " << p->sizeHist[b];
+        out << endl;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef _writeback_H
+#define _writeback_H
+
+#include <string>
+#include "policy.h"
+using namespace std;
+
+/*
+   Write-back simulation shared by every policy. Pages written while cached
+   are tracked as dirty; they reach the backend either when the policy
+   evicts them or through background flushing (dirty count above
+   dirtyRatio * cache size, or pages older than the expire age). Pending
+   page writes sit in a flush queue and are coalesced into sequential
+   write I/Os, together with dirty neighbours still resident in the cache.
+*/
+class WriteBackFlusher : public CacheObserver
+{
+public:
+    WriteBackFlusher(int cacheSize, double dirtyRatio);
+    ~WriteBackFlusher();
+
+    void onEvict(long long int addr, bool dirty);
+    void onAccess(long long int addr, bool write, bool hit);
+
+    // issue whatever is still sitting in the flush queue
+    void finish();
+
+    void report(const string& policy);
+
+private:
+    struct Impl;
+    Impl* p;
+};
+
+#endif